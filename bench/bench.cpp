@@ -0,0 +1,235 @@
+// GPZ 编码/解码宿主机基准。gps_data_encoder / gps_data_decoder 都不
+// 依赖 Arduino，可以直接用 g++ 编译，在 PC 上量化评估格式参数
+// （全量块间隔、V1/V2 段策略）对体积和吞吐的影响，省去刷机实测。
+//
+// 三种用法（见 bench/Makefile）：
+//   gpz_bench                     跑合成航迹基准 + 往返一致性校验
+//   gpz_bench --emit-ref <json>   导出 1e5 量化点集（gps_format.py 的
+//                                 encode 输入格式），供交叉校验
+//   gpz_bench --decode <gpz>      用 C++ 解码器解码文件，CSV 输出到
+//                                 stdout，与 gps_format.py decode 对账
+//
+// 往返误差预期：时间戳/海拔精确；V2 段经纬度精确；V1 段经纬度量化
+// 到 1e5（四舍五入），误差上限 50 个 1e7 单位（约 55 厘米）。
+
+#include "gps_data_decoder.h"
+#include "gps_data_encoder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// 确定性伪随机（基准结果可复现）
+uint32_t lcg_state = 0x12345678;
+uint32_t lcg_next() {
+  lcg_state = lcg_state * 1664525u + 1013904223u;
+  return lcg_state;
+}
+// [-range, +range] 均匀整数
+int32_t jitter(int32_t range) {
+  return static_cast<int32_t>(lcg_next() % (2u * range + 1)) - range;
+}
+
+int32_t div_round_s32(int32_t val, int32_t divisor) {
+  return (val >= 0) ? (val + divisor / 2) / divisor
+                    : (val - divisor / 2) / divisor;
+}
+
+// 合成航迹：从固定起点出发，每步前进 step_1e7（带抖动），采样间隔
+// interval_s。step ≈ 0 模拟静止（落入 V2 段），步行/车载为 V1 段。
+std::vector<GpxPointInternalV2> makeTrack(size_t count, uint32_t interval_s,
+                                          int32_t step_1e7,
+                                          int32_t jitter_1e7) {
+  std::vector<GpxPointInternalV2> track;
+  track.reserve(count);
+  GpxPointInternalV2 p;
+  p.timestamp = 1700000000u;
+  p.latitude_scaled_1e7 = 316000000;  // 31.6°N
+  p.longitude_scaled_1e7 = 1203000000; // 120.3°E
+  p.altitude_m_scaled_1e1 = 150;
+  for (size_t i = 0; i < count; i++) {
+    track.push_back(p);
+    p.timestamp += interval_s;
+    p.latitude_scaled_1e7 += step_1e7 + jitter(jitter_1e7);
+    p.longitude_scaled_1e7 += (step_1e7 * 2) / 3 + jitter(jitter_1e7);
+    p.altitude_m_scaled_1e1 += jitter(3);
+  }
+  return track;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+// 编码 + 解码 + 往返校验，打印一行统计。失败返回 false。
+bool runCase(const char *name, const std::vector<GpxPointInternalV2> &track,
+             int full_block_interval) {
+  std::vector<uint8_t> encoded(track.size() * GPZ_MAX_ENCODED_POINT_SIZE);
+
+  GpsDataEncoder encoder(full_block_interval);
+  auto t0 = std::chrono::steady_clock::now();
+  size_t total = 0;
+  for (size_t i = 0; i < track.size(); i++) {
+    uint32_t n =
+        encoder.encodeTo(track[i], &encoded[total], encoded.size() - total);
+    if (n == 0) {
+      fprintf(stderr, "%s: encodeTo 在点 %zu 处失败\n", name, i);
+      return false;
+    }
+    total += n;
+  }
+  double enc_s = secondsSince(t0);
+
+  GpsDataDecoder decoder;
+  GpxPointInternalV2 out;
+  size_t offset = 0;
+  size_t decoded_count = 0;
+  int32_t max_err_1e7 = 0;
+  t0 = std::chrono::steady_clock::now();
+  while (offset < total) {
+    uint32_t n = decoder.decodeNext(&encoded[offset], total - offset, &out);
+    if (n == 0) {
+      fprintf(stderr, "%s: decodeNext 在偏移 %zu 处失败\n", name, offset);
+      return false;
+    }
+    offset += n;
+    if (decoded_count >= track.size()) {
+      fprintf(stderr, "%s: 解出的点数多于输入\n", name);
+      return false;
+    }
+    const GpxPointInternalV2 &ref = track[decoded_count];
+    int32_t err_lat = out.latitude_scaled_1e7 - ref.latitude_scaled_1e7;
+    int32_t err_lon = out.longitude_scaled_1e7 - ref.longitude_scaled_1e7;
+    if (err_lat < 0) err_lat = -err_lat;
+    if (err_lon < 0) err_lon = -err_lon;
+    int32_t err = (err_lat > err_lon) ? err_lat : err_lon;
+    if (err > max_err_1e7) {
+      max_err_1e7 = err;
+    }
+    // 时间戳/海拔精确；经纬度误差只来自 V1 段的 1e5 量化（≤50）
+    if (out.timestamp != ref.timestamp ||
+        out.altitude_m_scaled_1e1 != ref.altitude_m_scaled_1e1 || err > 50) {
+      fprintf(stderr, "%s: 点 %zu 往返不一致 (err=%ld)\n", name, decoded_count,
+              (long)err);
+      return false;
+    }
+    decoded_count++;
+  }
+  double dec_s = secondsSince(t0);
+
+  if (decoded_count != track.size()) {
+    fprintf(stderr, "%s: 点数不符 %zu != %zu\n", name, decoded_count,
+            track.size());
+    return false;
+  }
+
+  double raw_bytes = (double)track.size() * sizeof(GpxPointInternalV2);
+  printf("%-12s %7zu pts  interval=%-3d  %8zu B  %5.2f B/pt  %5.1f%% of raw  "
+         "enc %6.2f Mpts/s  dec %6.2f Mpts/s  max_err=%ld (1e-7 deg)\n",
+         name, track.size(), full_block_interval, total,
+         (double)total / track.size(), 100.0 * total / raw_bytes,
+         track.size() / enc_s / 1e6, track.size() / dec_s / 1e6,
+         (long)max_err_1e7);
+  return true;
+}
+
+// 导出步行航迹的 1e5 量化点集，格式对齐 gps_format.py 的 encode 输入
+int emitRef(const char *path) {
+  std::vector<GpxPointInternalV2> track = makeTrack(2000, 10, 130000, 9000);
+  FILE *f = fopen(path, "w");
+  if (f == nullptr) {
+    fprintf(stderr, "无法写入 %s\n", path);
+    return 1;
+  }
+  fprintf(f, "{\n  \"points\": [\n");
+  for (size_t i = 0; i < track.size(); i++) {
+    fprintf(f,
+            "    {\"timestamp\": %lu, \"latitude_scaled\": %ld, "
+            "\"longitude_scaled\": %ld, \"altitude_scaled\": %ld}%s\n",
+            (unsigned long)track[i].timestamp,
+            (long)div_round_s32(track[i].latitude_scaled_1e7, 100),
+            (long)div_round_s32(track[i].longitude_scaled_1e7, 100),
+            (long)track[i].altitude_m_scaled_1e1,
+            (i + 1 < track.size()) ? "," : "");
+  }
+  fprintf(f, "  ]\n}\n");
+  fclose(f);
+  printf("已写入 %zu 个参考点到 %s\n", track.size(), path);
+  return 0;
+}
+
+// 解码 .gpz 文件，按 CSV 打印（与 gps_format.py decode 的输出对账）
+int decodeFile(const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (f == nullptr) {
+    fprintf(stderr, "无法读取 %s\n", path);
+    return 1;
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+    data.insert(data.end(), chunk, chunk + n);
+  }
+  fclose(f);
+
+  GpsDataDecoder decoder;
+  GpxPointInternalV2 out;
+  size_t offset = 0;
+  printf("timestamp,lat_1e7,lon_1e7,alt_1e1\n");
+  while (offset < data.size()) {
+    uint32_t consumed =
+        decoder.decodeNext(&data[offset], data.size() - offset, &out);
+    if (consumed == 0) {
+      fprintf(stderr, "解码在偏移 %zu 处停止（块头 0x%02X）\n", offset,
+              data[offset]);
+      return 1;
+    }
+    offset += consumed;
+    printf("%lu,%ld,%ld,%ld\n", (unsigned long)out.timestamp,
+           (long)out.latitude_scaled_1e7, (long)out.longitude_scaled_1e7,
+           (long)out.altitude_m_scaled_1e1);
+  }
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc == 3 && strcmp(argv[1], "--emit-ref") == 0) {
+    return emitRef(argv[2]);
+  }
+  if (argc == 3 && strcmp(argv[1], "--decode") == 0) {
+    return decodeFile(argv[2]);
+  }
+  if (argc != 1) {
+    fprintf(stderr,
+            "用法: %s [--emit-ref <json> | --decode <gpz>]\n", argv[0]);
+    return 2;
+  }
+
+  bool ok = true;
+  // 静止：抖动 ±3 个 1e7 单位（厘米级），应全程 V2 段
+  ok &= runCase("stationary", makeTrack(50000, 10, 0, 3), 64);
+  // 步行：约 1.4 m/s × 10 s ≈ 13000 个 1e7 单位/采样，V1 段
+  ok &= runCase("walking", makeTrack(50000, 10, 130000, 9000), 64);
+  // 车载：约 20 m/s × 10 s
+  ok &= runCase("driving", makeTrack(50000, 10, 1800000, 120000), 64);
+  // 全量块间隔对比（步行航迹）
+  ok &= runCase("walking", makeTrack(50000, 10, 130000, 9000), 16);
+  ok &= runCase("walking", makeTrack(50000, 10, 130000, 9000), 128);
+  // 每点全量块 = 无压缩基线
+  ok &= runCase("walking", makeTrack(50000, 10, 130000, 9000), 1);
+
+  if (!ok) {
+    fprintf(stderr, "基准中有用例失败\n");
+    return 1;
+  }
+  printf("所有往返校验通过\n");
+  return 0;
+}
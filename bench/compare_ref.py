@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""Compare gps_format.py decode output against the C++ decoder CSV.
+
+Used by `make check`: both decoders consume the same V1-only .gpz file
+(gps_format.py cannot emit or parse V2 blocks), so every point must match
+exactly after scaling the Python tool's 1e5 values to 1e7.
+"""
+
+import csv
+import json
+import sys
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(f"usage: {sys.argv[0]} <python_decode.json> <cpp_decode.csv>")
+        return 2
+
+    with open(sys.argv[1], "r", encoding="utf-8") as f:
+        ref_points = json.load(f)["points"]
+    # decode 的输出把字段包在每项的 "data" 里
+    ref_points = [p.get("data", p) for p in ref_points]
+
+    with open(sys.argv[2], "r", encoding="utf-8", newline="") as f:
+        cpp_points = list(csv.DictReader(f))
+
+    if len(ref_points) != len(cpp_points):
+        print(
+            f"point count mismatch: python={len(ref_points)} "
+            f"cpp={len(cpp_points)}"
+        )
+        return 1
+
+    for i, (ref, cpp) in enumerate(zip(ref_points, cpp_points)):
+        expected = (
+            ref["timestamp"],
+            ref["latitude_scaled"] * 100,
+            ref["longitude_scaled"] * 100,
+            ref["altitude_scaled"],
+        )
+        actual = (
+            int(cpp["timestamp"]),
+            int(cpp["lat_1e7"]),
+            int(cpp["lon_1e7"]),
+            int(cpp["alt_1e1"]),
+        )
+        if expected != actual:
+            print(f"point {i} mismatch: python={expected} cpp={actual}")
+            return 1
+
+    print(f"OK: {len(ref_points)} points match gps_format.py output")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
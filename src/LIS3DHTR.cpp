@@ -464,6 +464,90 @@ template <class T> void LIS3DHTR<T>::setInterrupt(void) {
                 0x2a); // trigger when ZHIE/YHIE/XHIE
 }
 
+template <class T> void LIS3DHTR<T>::enableFIFOStream(void) {
+  uint8_t config5 = readRegister(LIS3DHTR_REG_ACCEL_CTRL_REG5);
+  config5 |= 0x40; // FIFO_EN
+  writeRegister(LIS3DHTR_REG_ACCEL_CTRL_REG5, config5);
+  // FM = 10 (stream mode): FIFO满后持续覆盖最旧样本
+  writeRegister(LIS3DHTR_REG_ACCEL_FIFO_CTRL, 0x80);
+}
+
+template <class T> void LIS3DHTR<T>::disableFIFO(void) {
+  writeRegister(LIS3DHTR_REG_ACCEL_FIFO_CTRL, 0x00); // bypass
+  uint8_t config5 = readRegister(LIS3DHTR_REG_ACCEL_CTRL_REG5);
+  config5 &= ~0x40;
+  writeRegister(LIS3DHTR_REG_ACCEL_CTRL_REG5, config5);
+}
+
+template <class T> uint8_t LIS3DHTR<T>::getFifoCount(void) {
+  // FSS[4:0] = 未读样本数；OVRN置位时FIFO已满（32个有效样本）
+  uint8_t src = readRegister(LIS3DHTR_REG_ACCEL_FIFO_SRC);
+  uint8_t count = src & 0x1F;
+  if (src & 0x40) { // OVRN
+    count = 32;
+  }
+  return count;
+}
+
+template <class T>
+uint8_t LIS3DHTR<T>::readFifo(float *x, float *y, float *z,
+                              uint8_t maxSamples) {
+  uint8_t count = getFifoCount();
+  if (count > maxSamples) {
+    count = maxSamples;
+  }
+  if (count == 0) {
+    return 0;
+  }
+
+  // 单次突发事务读出count*6字节：LIS3DH的地址自增在OUT_Z_H后
+  // 自动回卷到OUT_X_L，每读完6字节弹出一个FIFO样本
+  uint8_t buf[32 * 6];
+  readRegisterRegion(buf, LIS3DHTR_REG_ACCEL_OUT_X_L, count * 6);
+
+  for (uint8_t i = 0; i < count; i++) {
+    int16_t raw_x, raw_y, raw_z;
+    memcpy(&raw_x, buf + i * 6 + 0, 2);
+    memcpy(&raw_y, buf + i * 6 + 2, 2);
+    memcpy(&raw_z, buf + i * 6 + 4, 2);
+    x[i] = (float)raw_x / accRange;
+    y[i] = (float)raw_y / accRange;
+    z[i] = (float)raw_z / accRange;
+  }
+  return count;
+}
+
+template <class T>
+void LIS3DHTR<T>::enableMotionInterrupt(uint8_t threshold, uint8_t duration) {
+  // IA1中断路由到INT1引脚（不动CTRL_REG1/REG4里的ODR和量程配置）
+  uint8_t config3 = readRegister(LIS3DHTR_REG_ACCEL_CTRL_REG3);
+  config3 |= LIS3DHTR_CTRL_REG3_IA1_ENABLE;
+  writeRegister(LIS3DHTR_REG_ACCEL_CTRL_REG3, config3);
+
+  // 高通滤波送IA1，滤掉重力分量，只响应加速度变化
+  writeRegister(LIS3DHTR_REG_ACCEL_CTRL_REG2, 0x09); // HPIS1 | HPCF
+
+  writeRegister(LIS3DHTR_REG_ACCEL_INT1_THS, threshold);
+  writeRegister(LIS3DHTR_REG_ACCEL_INT1_DURATION, duration);
+
+  (void)readRegister(LIS3DHTR_REG_ACCEL_INT1_SRC); // 清掉历史标志
+
+  // ZHIE | YHIE | XHIE：任一轴高事件触发
+  writeRegister(LIS3DHTR_REG_ACCEL_INT1_CFG, 0x2A);
+}
+
+template <class T> void LIS3DHTR<T>::disableMotionInterrupt(void) {
+  writeRegister(LIS3DHTR_REG_ACCEL_INT1_CFG, 0x00);
+  uint8_t config3 = readRegister(LIS3DHTR_REG_ACCEL_CTRL_REG3);
+  config3 &= ~LIS3DHTR_CTRL_REG3_IA1_MASK;
+  writeRegister(LIS3DHTR_REG_ACCEL_CTRL_REG3, config3);
+  writeRegister(LIS3DHTR_REG_ACCEL_CTRL_REG2, 0x00);
+}
+
+template <class T> uint8_t LIS3DHTR<T>::clearMotionInterrupt(void) {
+  return readRegister(LIS3DHTR_REG_ACCEL_INT1_SRC);
+}
+
 template <class T> LIS3DHTR<T>::operator bool() { return isConnection(); }
 
 template class LIS3DHTR<SPIClass>;
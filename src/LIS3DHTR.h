@@ -319,6 +319,20 @@ public:
 
   void setInterrupt(void);
 
+  // --- FIFO (32级硬件FIFO，stream模式) ---
+  void enableFIFOStream(void);   // 打开FIFO stream模式
+  void disableFIFO(void);        // 关闭FIFO，回到bypass
+  uint8_t getFifoCount(void);    // FIFO中未读样本数 (0-32)
+  // 一次突发I2C事务读出最多maxSamples个样本（每样本6字节，
+  // 地址自增在OUT_Z_H后自动回卷），返回实际读出的样本数
+  uint8_t readFifo(float *x, float *y, float *z, uint8_t maxSamples);
+
+  // --- 运动阈值中断 (INT1, IA1) ---
+  // threshold单位与量程有关：2g量程下16mg/LSB；duration单位为1/ODR
+  void enableMotionInterrupt(uint8_t threshold, uint8_t duration);
+  void disableMotionInterrupt(void);
+  uint8_t clearMotionInterrupt(void); // 读INT1_SRC清除锁存标志
+
   void openTemp();
   void closeTemp();
 
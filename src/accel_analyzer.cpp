@@ -1,48 +1,60 @@
 #include "accel_analyzer.h"
-#include "cmath"
-#include "logger.h"
 #include <algorithm>
+#include <cmath>
 
 AccelAnalyzer::AccelAnalyzer(size_t historySize, float stillThreshold,
                              float jumpThreshold)
-    : history(historySize), stillThreshold(stillThreshold),
-      jumpThreshold(jumpThreshold) {}
+    : history(historySize), window_min(historySize, false),
+      window_max(historySize, true), sample_index(0), running_sum(0.0f),
+      running_sum_sq(0.0f), last_sample(0.0f), second_last_sample(0.0f),
+      stillThreshold(stillThreshold), jumpThreshold(jumpThreshold) {}
 
-void AccelAnalyzer::addSample(float totalAccel) { history.push(totalAccel); }
+void AccelAnalyzer::addSample(float totalAccel) {
+  // 窗口已满时，即将被覆盖的最旧样本先从运行和中扣掉
+  if (history.size() == history.max_size()) {
+    float evicted = history[0];
+    running_sum -= evicted;
+    running_sum_sq -= evicted * evicted;
+  }
+  history.push(totalAccel);
+  running_sum += totalAccel;
+  running_sum_sq += totalAccel * totalAccel;
+
+  // 单调队列维护窗口极值（均摊 O(1)）
+  window_min.push(sample_index, totalAccel, (uint32_t)history.max_size());
+  window_max.push(sample_index, totalAccel, (uint32_t)history.max_size());
+  sample_index++;
+
+  second_last_sample = last_sample;
+  last_sample = totalAccel;
+}
 
 bool AccelAnalyzer::isStill() const {
-  if (history.size() == 0)
+  if (sample_index == 0 || window_min.empty() || window_max.empty())
     return false;
-  float minVal = history[0], maxVal = history[0];
-  for (size_t i = 1; i < history.size(); ++i) {
-    if (history[i] < minVal)
-      minVal = history[i];
-    if (history[i] > maxVal)
-      maxVal = history[i];
-  }
-  // Log.print("Min: ");
-  // Log.print(minVal);
-  // Log.print(", Max: ");
-  // Log.print(maxVal);
-  // Log.print(", Still Threshold: ");
-  // Log.print(stillThreshold);
-  // Log.print(" difference: ");
-  // Log.println(maxVal - minVal);
-  return (maxVal - minVal) < stillThreshold;
+  return (window_max.front() - window_min.front()) < stillThreshold;
 }
 
 bool AccelAnalyzer::hasJump() const {
-  if (history.size() < 2)
+  if (sample_index < 2)
     return false;
-  auto last_accel = history[history.size() - 1];
-  auto second_last_accel = history[history.size() - 2];
-  auto diff = abs(last_accel - second_last_accel);
-  if (diff > jumpThreshold || last_accel < 0.2f) {
+  float diff = fabsf(last_sample - second_last_sample);
+  if (diff > jumpThreshold || last_sample < 0.2f) {
     return true;
   }
   return false;
 }
 
+float AccelAnalyzer::variance() const {
+  size_t n = history.size();
+  if (n < 2)
+    return 0.0f;
+  // Var = E[x^2] - E[x]^2，运行和直接给出，无需扫描
+  float mean = running_sum / (float)n;
+  float var = running_sum_sq / (float)n - mean * mean;
+  return (var > 0.0f) ? var : 0.0f; // 浮点抵消可能出负，钳到 0
+}
+
 void AccelAnalyzer::setStillThreshold(float threshold) {
   stillThreshold = threshold;
 }
@@ -51,4 +63,13 @@ void AccelAnalyzer::setJumpThreshold(float threshold) {
   jumpThreshold = threshold;
 }
 
-void AccelAnalyzer::setHistorySize(size_t size) { history = Ring<float>(size); }
+void AccelAnalyzer::setHistorySize(size_t size) {
+  history = Ring<float>(size);
+  window_min = SlidingExtremum(size, false);
+  window_max = SlidingExtremum(size, true);
+  sample_index = 0;
+  running_sum = 0.0f;
+  running_sum_sq = 0.0f;
+  last_sample = 0.0f;
+  second_last_sample = 0.0f;
+}
@@ -2,6 +2,7 @@
 #define ACCEL_ANALYZER_H
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 // 通用的环形缓冲区模板，底层用std::vector管理内存
@@ -31,28 +32,90 @@ private:
   size_t count;
 };
 
+// 单调队列：O(1) 均摊维护滑动窗口的最小/最大值。
+// 内存在构造时一次性分配，push 不触碰堆。
+class SlidingExtremum {
+public:
+  SlidingExtremum(size_t capacity, bool track_max)
+      : entries(capacity), capacity(capacity), head(0), count(0),
+        track_max(track_max) {}
+
+  // 加入第 idx 个样本（idx 单调递增），并淘汰滑出窗口的旧值
+  void push(uint32_t idx, float val, uint32_t window) {
+    // 队尾弹出所有被新样本"支配"的旧值
+    while (count > 0) {
+      const Entry &back = entries[(head + count - 1) % capacity];
+      if (track_max ? (back.val <= val) : (back.val >= val)) {
+        --count;
+      } else {
+        break;
+      }
+    }
+    entries[(head + count) % capacity] = Entry{idx, val};
+    ++count;
+    // 队头淘汰已滑出窗口的样本
+    while (count > 0 && entries[head].idx + window <= idx) {
+      head = (head + 1) % capacity;
+      --count;
+    }
+  }
+
+  bool empty() const { return count == 0; }
+  float front() const { return entries[head].val; } // 当前窗口的极值
+
+  void clear() {
+    head = 0;
+    count = 0;
+  }
+
+private:
+  struct Entry {
+    uint32_t idx;
+    float val;
+  };
+  std::vector<Entry> entries;
+  size_t capacity;
+  size_t head;
+  size_t count;
+  bool track_max;
+};
+
+// 加速度分析器：静止/跳变判定全部 O(1)。
+// addSample() 增量维护滑动窗口的 min/max（单调队列）和运行和/
+// 平方和（方差随取随算），查询不再扫描整个历史窗口。
+// 这让采样率可以提到 50 Hz 而不增加循环耗时。
 class AccelAnalyzer {
 public:
   // 构造函数，historySize为分析窗口长度，stillThreshold为静止判定阈值（g），jumpThreshold为跳变判定阈值（g）
   AccelAnalyzer(size_t historySize = 50, float stillThreshold = 0.03f,
                 float jumpThreshold = 0.5f);
 
-  // 添加一条新的总加速度数据
+  // 添加一条新的总加速度数据（O(1) 均摊）
   void addSample(float totalAccel);
 
-  // 判断过去一段时间是否静止
+  // 判断过去一段时间是否静止（O(1)）
   bool isStill() const;
 
-  // 判断过去一段时间是否有跳变
+  // 判断过去一段时间是否有跳变（O(1)）
   bool hasJump() const;
 
+  // 窗口内方差（运动分类用；O(1)）
+  float variance() const;
+
   // 可选：设置参数
   void setStillThreshold(float threshold);
   void setJumpThreshold(float threshold);
   void setHistorySize(size_t size);
 
 private:
-  Ring<float> history;
+  Ring<float> history; // 原始窗口（淘汰时扣减运行和用）
+  SlidingExtremum window_min;
+  SlidingExtremum window_max;
+  uint32_t sample_index; // 已加入的样本总数（单调递增）
+  float running_sum;     // 窗口内样本和
+  float running_sum_sq;  // 窗口内样本平方和
+  float last_sample;     // 最近两个样本（跳变判定用）
+  float second_last_sample;
   float stillThreshold;
   float jumpThreshold;
 };
@@ -1,4 +1,5 @@
 #include "accel_handler.h"
+#include "config.h"
 #include "i2c_lock.h"
 #include "logger.h"
 #include <LIS3DHTR.h>
@@ -6,7 +7,16 @@
 
 AccelHandler accelHandler;
 
-AccelHandler::AccelHandler() : ok(false), last_x(0), last_y(0), last_z(0) {}
+// GPIO中断标志（ISR上下文只置位，loop侧consume）
+static volatile bool motionWakeFlag = false;
+
+#ifdef PIN_ACCEL_INT
+static void accelIntIsr() { motionWakeFlag = true; }
+#endif
+
+AccelHandler::AccelHandler()
+    : ok(false), motionWakeArmed(false), idleSampling(false), last_x(0),
+      last_y(0), last_z(0) {}
 
 bool AccelHandler::begin(uint8_t addr) {
   I2C_LockGuard lock;
@@ -17,6 +27,8 @@ bool AccelHandler::begin(uint8_t addr) {
     lis.setOutputDataRate(LIS3DHTR_DATARATE_50HZ);
     lis.setHighSolution(true);
     lis.setFullScaleRange(LIS3DHTR_RANGE_2G);
+    // 片上FIFO stream模式：样本在片内累积，主机按批突发读出
+    lis.enableFIFOStream();
   } else {
     ok = false;
     Log.println("LIS3DHTR 初始化失败");
@@ -31,16 +43,102 @@ void AccelHandler::update() {
   }
   float x, y, z;
   {
-    I2C_LockGuard lock;
+    I2C_LockGuard lock(I2C_PRIO_HIGH);
     lis.getAcceleration(&x, &y, &z);
   }
   last_x = x;
   last_y = y;
   last_z = z;
-  float total = sqrt(x * x + y * y + z * z);
-  // Log.print("LIS3DHTR 加速度: ");
-  // Log.print(total);
-  // Log.println(" g");
+}
+
+uint8_t AccelHandler::drainFifo(AccelAnalyzer &analyzer) {
+  if (!ok) {
+    return 0;
+  }
+  float x[32], y[32], z[32];
+  uint8_t count;
+  {
+    I2C_LockGuard lock(I2C_PRIO_HIGH);
+    count = lis.readFifo(x, y, z, 32);
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    analyzer.addSample(sqrtf(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]));
+  }
+  if (count > 0) {
+    last_x = x[count - 1];
+    last_y = y[count - 1];
+    last_z = z[count - 1];
+  }
+  return count;
+}
+
+bool AccelHandler::armMotionWake() {
+#ifdef PIN_ACCEL_INT
+  if (!ok) {
+    return false;
+  }
+  if (motionWakeArmed) {
+    return true;
+  }
+  {
+    I2C_LockGuard lock(I2C_PRIO_HIGH);
+    lis.enableMotionInterrupt(ACCEL_WAKE_THRESHOLD_LSB,
+                              ACCEL_WAKE_DURATION_LSB);
+  }
+  motionWakeFlag = false;
+  pinMode(PIN_ACCEL_INT, INPUT);
+  attachInterrupt(digitalPinToInterrupt(PIN_ACCEL_INT), accelIntIsr, RISING);
+  motionWakeArmed = true;
+  Log.println("Accel motion wake armed");
+  return true;
+#else
+  return false; // 板子没接INT1，调用方退回轮询
+#endif
+}
+
+void AccelHandler::disarmMotionWake() {
+#ifdef PIN_ACCEL_INT
+  if (!motionWakeArmed) {
+    return;
+  }
+  detachInterrupt(digitalPinToInterrupt(PIN_ACCEL_INT));
+  {
+    I2C_LockGuard lock(I2C_PRIO_HIGH);
+    lis.disableMotionInterrupt();
+    lis.clearMotionInterrupt();
+  }
+  motionWakeArmed = false;
+  motionWakeFlag = false;
+  Log.println("Accel motion wake disarmed");
+#endif
+}
+
+bool AccelHandler::isMotionWakeArmed() const { return motionWakeArmed; }
+
+void AccelHandler::setIdleSampling(bool idle) {
+  if (!ok || idle == idleSampling) {
+    return;
+  }
+  {
+    I2C_LockGuard lock(I2C_PRIO_HIGH);
+    lis.setOutputDataRate(idle ? LIS3DHTR_DATARATE_10HZ
+                               : LIS3DHTR_DATARATE_50HZ);
+  }
+  idleSampling = idle;
+}
+
+bool AccelHandler::consumeMotionWake() {
+  if (!motionWakeFlag) {
+    return false;
+  }
+  motionWakeFlag = false;
+#ifdef PIN_ACCEL_INT
+  if (motionWakeArmed) {
+    I2C_LockGuard lock(I2C_PRIO_HIGH);
+    lis.clearMotionInterrupt(); // 释放锁存，允许下一次触发
+  }
+#endif
+  return true;
 }
 
 void AccelHandler::get(float *x, float *y, float *z) const {
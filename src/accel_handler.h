@@ -1,5 +1,6 @@
 #ifndef ACCEL_HANDLER_H
 #define ACCEL_HANDLER_H
+#include "accel_analyzer.h"
 #include "i2c_lock.h"
 #include <Arduino.h>
 #include <LIS3DHTR.h>
@@ -9,13 +10,30 @@ public:
   AccelHandler();
   bool begin(uint8_t addr = 0x19);
   void update();
+  // 一次突发I2C事务排空片上FIFO（最多32个样本），每个样本的总加
+  // 速度喂给analyzer。返回读出的样本数。比逐样本读省约10倍总线占用
+  uint8_t drainFifo(AccelAnalyzer &analyzer);
   void get(float *x, float *y, float *z) const;
   float getTotal() const;
   bool isOk() const;
 
+  // --- 运动唤醒（INT1），S2下停止轮询用 ---
+  // 需要 PIN_ACCEL_INT；未定义时armMotionWake()返回false，调用方退回轮询
+  bool armMotionWake();    // 配置阈值中断并挂GPIO中断
+  void disarmMotionWake(); // 关闭阈值中断
+  bool isMotionWakeArmed() const;
+  bool consumeMotionWake(); // 取走并清除"有动静"标志
+
+  // 空闲档采样率切换（见 power_tier.h）：S2 轮询兜底模式下把 ODR
+  // 从 50Hz 降到 10Hz，芯片功耗和 FIFO 排空流量都降到 1/5。
+  // S4 不降——静止分析器正依赖满采样率做判决
+  void setIdleSampling(bool idle);
+
 private:
   LIS3DHTR<TwoWire> lis;
   bool ok;
+  bool motionWakeArmed;
+  bool idleSampling;
   float last_x, last_y, last_z;
 };
 
@@ -0,0 +1,79 @@
+#include "agnss_ring.h"
+#include <string.h>
+
+AgnssRing agnssRing;
+
+AgnssRing::AgnssRing() { reset(); }
+
+void AgnssRing::reset() {
+  _head = 0;
+  _tail = 0;
+  _pushed = 0;
+  _popped = 0;
+  _streamDone = false;
+}
+
+void AgnssRing::copyIn(size_t offset, const uint8_t *src, size_t len) {
+  size_t firstPart = AGNSS_RING_CAPACITY - offset;
+  if (firstPart >= len) {
+    memcpy(_arena + offset, src, len);
+  } else {
+    memcpy(_arena + offset, src, firstPart);
+    memcpy(_arena, src + firstPart, len - firstPart);
+  }
+}
+
+void AgnssRing::copyOut(size_t offset, uint8_t *dst, size_t len) const {
+  size_t firstPart = AGNSS_RING_CAPACITY - offset;
+  if (firstPart >= len) {
+    memcpy(dst, _arena + offset, len);
+  } else {
+    memcpy(dst, _arena + offset, firstPart);
+    memcpy(dst + firstPart, _arena, len - firstPart);
+  }
+}
+
+bool AgnssRing::push(const uint8_t *data, uint16_t len) {
+  if (data == nullptr || len == 0 || len > AGNSS_MAX_MESSAGE_SIZE) {
+    return false;
+  }
+  size_t need = (size_t)len + 2;
+  if (need > freeBytes()) {
+    return false; // 环满，调用方背压
+  }
+  size_t tail = _tail;
+  uint8_t hdr[2] = {(uint8_t)(len & 0xFF), (uint8_t)(len >> 8)};
+  copyIn(tail, hdr, 2);
+  copyIn((tail + 2) % AGNSS_RING_CAPACITY, data, len);
+  // 数据就位后才发布新 tail，消费者不会读到半条消息
+  _tail = (tail + need) % AGNSS_RING_CAPACITY;
+  _pushed = _pushed + 1;
+  return true;
+}
+
+uint16_t AgnssRing::peek(uint8_t *dst, uint16_t cap) const {
+  if (empty() || dst == nullptr) {
+    return 0;
+  }
+  size_t head = _head;
+  uint8_t hdr[2];
+  copyOut(head, hdr, 2);
+  uint16_t len = (uint16_t)hdr[0] | ((uint16_t)hdr[1] << 8);
+  if (len > cap) {
+    return 0;
+  }
+  copyOut((head + 2) % AGNSS_RING_CAPACITY, dst, len);
+  return len;
+}
+
+void AgnssRing::pop() {
+  if (empty()) {
+    return;
+  }
+  size_t head = _head;
+  uint8_t hdr[2];
+  copyOut(head, hdr, 2);
+  size_t len = (size_t)((uint16_t)hdr[0] | ((uint16_t)hdr[1] << 8)) + 2;
+  _head = (head + len) % AGNSS_RING_CAPACITY;
+  _popped = _popped + 1;
+}
@@ -0,0 +1,72 @@
+#ifndef AGNSS_RING_H
+#define AGNSS_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// A-GNSS 消息的固定字节环（无堆）。BLE 侧按块写入（生产者），
+// S5 状态机边到边注入（消费者），两个阶段在时间上重叠：
+// 收一条注一条，不再等全部 70 条消息攒齐后才开始。
+// 环比全量小得多——注入速率约 1 条/秒，BLE 到达更快时由
+// 生产者侧背压（环满让客户端稍后重发该块）。
+//
+// 单生产者/单消费者：BLE RX 回调只写 _tail，loop 侧只写 _head，
+// 留一个空闲字节区分满/空，不需要共享计数器也就不需要加锁。
+// 存储格式：[len:2 LE][data]，字节环回绕，读出时拷到调用方的
+// 暂存缓冲区（GPS 串口写需要连续内存）。
+
+// 单条 CASIC 消息上限（BLE 命令缓冲 570 扣掉头部）
+#define AGNSS_MAX_MESSAGE_SIZE 568
+// 环容量：约可缓冲 10 条最大消息，覆盖 BLE 与 UART 的速率差
+#define AGNSS_RING_CAPACITY (6 * 1024)
+
+class AgnssRing {
+public:
+  AgnssRing();
+
+  // 清空环并复位计数与流结束标志（开始新一轮传输时调用，
+  // 注意只能在没有并发读写的时机调，如会话开始/结束）
+  void reset();
+
+  // 生产者：追加一条完整消息。环满返回 false（调用方背压重试）
+  bool push(const uint8_t *data, uint16_t len);
+
+  // 消费者：把队首消息拷到 dst（容量 cap），返回消息长度，
+  // 空或 cap 不足返回 0。不出队——重试期间消息留在队首
+  uint16_t peek(uint8_t *dst, uint16_t cap) const;
+
+  // 消费者：丢弃队首消息（收到 ACK 后调用）
+  void pop();
+
+  bool empty() const { return _head == _tail; }
+  size_t freeBytes() const {
+    return AGNSS_RING_CAPACITY - 1 - usedBytes();
+  }
+
+  // BLE 侧发完 END 后置位；环空且流结束 = 本轮注入完成
+  void setStreamDone(bool done) { _streamDone = done; }
+  bool streamDone() const { return _streamDone; }
+
+  // 会话累计计数（pushed 仅生产者写，popped 仅消费者写，进度日志用）
+  uint16_t pushedCount() const { return _pushed; }
+  uint16_t poppedCount() const { return _popped; }
+
+private:
+  uint8_t _arena[AGNSS_RING_CAPACITY];
+  volatile size_t _head; // 下一条消息的读偏移（仅消费者写）
+  volatile size_t _tail; // 下一条消息的写偏移（仅生产者写）
+  volatile uint16_t _pushed;
+  volatile uint16_t _popped;
+  volatile bool _streamDone;
+
+  size_t usedBytes() const {
+    size_t h = _head, t = _tail;
+    return (t >= h) ? (t - h) : (AGNSS_RING_CAPACITY - h + t);
+  }
+  void copyOut(size_t offset, uint8_t *dst, size_t len) const;
+  void copyIn(size_t offset, const uint8_t *src, size_t len);
+};
+
+extern AgnssRing agnssRing;
+
+#endif // AGNSS_RING_H
@@ -0,0 +1,88 @@
+#include "altitude_fusion.h"
+#include "bmp280_handler.h"
+#include "config.h"
+#include "gpx_logger.h"
+#include "logger.h"
+#include <Arduino.h>
+
+// 标定状态：气压海拔与 GPS 海拔的偏移（厘米，EMA 平滑）
+static bool calibrated = false;
+static int32_t baroOffsetCm = 0;     // baro - gps
+static unsigned long lastCalibMs = 0;
+
+// GPS 关机期间落盘用的外推基准
+static uint32_t baseUnixTs = 0;      // 最后标定时的 GPS 时间
+static unsigned long baseMs = 0;     // 对应的 millis()
+static int32_t lastFixLat1e7 = 0;
+static int32_t lastFixLon1e7 = 0;
+
+// S2/S4 落盘节流
+static int32_t lastLoggedAltCm = 0;
+static unsigned long lastLogMs = 0;
+
+static int32_t baroAltitudeCm() {
+  return (int32_t)(bmp280Handler.getAltitude() * 100.0f);
+}
+
+void altitudeFusionCalibrate(uint32_t unix_ts, int32_t lat_1e7,
+                             int32_t lon_1e7, int32_t gps_altitude_cm) {
+  if (!bmp280Handler.isOk() || unix_ts == 0) {
+    return;
+  }
+  int32_t sample = baroAltitudeCm() - gps_altitude_cm;
+  if (!calibrated) {
+    baroOffsetCm = sample;
+    calibrated = true;
+    Log.printf("海拔融合：初始标定偏移 %ld cm\n", (long)baroOffsetCm);
+  } else {
+    // EMA：每次向新样本靠 1/8，单次 GPS 海拔噪声不会打歪偏移
+    baroOffsetCm += (sample - baroOffsetCm) / 8;
+  }
+  lastCalibMs = millis();
+  baseUnixTs = unix_ts;
+  baseMs = lastCalibMs;
+  lastFixLat1e7 = lat_1e7;
+  lastFixLon1e7 = lon_1e7;
+  lastLoggedAltCm = gps_altitude_cm;
+}
+
+bool altitudeFusionValid() {
+  return calibrated && bmp280Handler.isOk() &&
+         (millis() - lastCalibMs) < ALTITUDE_FUSION_CALIB_VALID_MS;
+}
+
+bool altitudeFusionAltitudeCm(int32_t *out_cm) {
+  if (!altitudeFusionValid() || out_cm == nullptr) {
+    return false;
+  }
+  *out_cm = baroAltitudeCm() - baroOffsetCm;
+  return true;
+}
+
+void serviceAltitudeFusion() {
+  int32_t fusedCm;
+  if (!altitudeFusionAltitudeCm(&fusedCm)) {
+    return;
+  }
+
+  unsigned long now = millis();
+  if (now - lastLogMs < ALTITUDE_FUSION_MIN_LOG_INTERVAL_MS) {
+    return;
+  }
+  int32_t diff = fusedCm - lastLoggedAltCm;
+  if (diff < 0) {
+    diff = -diff;
+  }
+  if (diff < ALTITUDE_FUSION_LOG_THRESHOLD_CM) {
+    return;
+  }
+
+  // 位置沿用最后定位点，时间戳按 millis 外推；点里只有 TS 和 ALT
+  // 有增量，编码后每点只有几个字节
+  uint32_t ts = baseUnixTs + (uint32_t)((now - baseMs) / 1000);
+  if (appendGpxPointFixed(ts, lastFixLat1e7, lastFixLon1e7, fusedCm)) {
+    Log.printf("海拔融合：GPS 关机中记录气压海拔 %ld cm\n", (long)fusedCm);
+    lastLoggedAltCm = fusedCm;
+    lastLogMs = now;
+  }
+}
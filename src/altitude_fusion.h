@@ -0,0 +1,27 @@
+#ifndef ALTITUDE_FUSION_H
+#define ALTITUDE_FUSION_H
+
+#include <stdint.h>
+
+// 气压/GPS 海拔融合：S3 定位期间用 GPS 海拔标定气压海拔的偏移
+// （EMA 平滑），GPS 关机的 S2/S4 里继续用 BMP280 推算海拔变化并
+// 落盘——位置沿用最后一次定位点，只有时间戳和海拔在变，编码器的
+// 差分压缩会把这类点压到每点几个字节。徒步场景下高程曲线不再
+// 依赖延长 GPS 开机时间。
+
+// S3 采样时调用：用当前 GPS 海拔标定气压偏移，并记录外推基准
+// （最后定位的位置 + GPS 时间 + millis 锚点）
+void altitudeFusionCalibrate(uint32_t unix_ts, int32_t lat_1e7,
+                             int32_t lon_1e7, int32_t gps_altitude_cm);
+
+// S2/S4 里周期调用：标定有效且海拔变化超过阈值时落盘一个
+// 气压推算点（GPS 不开机）
+void serviceAltitudeFusion();
+
+// 标定是否仍然有效（超过有效期后气压天气漂移不可忽略）
+bool altitudeFusionValid();
+
+// 融合后的当前海拔 (厘米)；标定无效时返回 false，out 不写
+bool altitudeFusionAltitudeCm(int32_t *out_cm);
+
+#endif // ALTITUDE_FUSION_H
@@ -1,4 +1,5 @@
 #include "battery.h"
+#include "battery_telemetry.h"
 #include "system_info.h"
 #include "variant.h" // Includes board-specific definitions like BATTERY_PIN, REAL_VBAT_MV_PER_LSB etc.
 #include <Arduino.h>
@@ -124,7 +125,12 @@ void updateBatteryInfo(TimerHandle_t handle) {
   uint32_t voltageMv = readBatteryVoltageMv();
   if (voltageMv > 0) {
     gSystemInfo.batteryVoltage = voltageMv / 1000.0f; // 转换为伏特
+    // 遥测环记录电压 + 当时的 GPS 负载状态（内部抽稀）
+    batteryTelemetryUpdate((uint16_t)voltageMv, (uint8_t)gSystemInfo.gpsState);
   } else {
     gSystemInfo.batteryVoltage = -1.0f; // 表示无效读数
   }
+  // 不在这里发布快照：本回调跑在 timer 任务，发布时整体拷贝可能
+  // 撞上 loop 任务写了一半的 GPS 字段。batteryVoltage 是单个对齐
+  // 的 32 位写（M4 上原子），由 loop 侧的发布点顺带带出去
 }
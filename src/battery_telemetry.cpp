@@ -0,0 +1,116 @@
+#include "battery_telemetry.h"
+#include "battery.h"
+#include "system_info.h"
+#include <Arduino.h>
+
+// 采样抽稀间隔：电池定时器 1 Hz 触发，这里按 10 s 落一条，
+// 256 条环覆盖最近 ~42 分钟
+#define BATTERY_TELEMETRY_SAMPLE_INTERVAL_MS (10UL * 1000)
+// 负载跃变（GPS 开→关）后等电压回稳再取静息读数
+#define BATTERY_SAG_SETTLE_MS (5UL * 1000)
+// SoC 输出的 EMA 平滑系数
+#define BATTERY_SOC_EMA_ALPHA 0.05f
+
+static BatteryTelemetrySample ring[BATTERY_TELEMETRY_CAPACITY];
+// 单调递增的写入总数；生产者（定时器任务）先写槽位再发布计数，
+// 消费者（主循环导出）只读。环绕覆盖最旧条目
+static volatile uint32_t totalCount = 0;
+
+// --- 负载压降模型 ---
+// GPS 开机时内阻压降把电压拉低，直接查表 SoC 会在开关机间跳变。
+// 在开→关跃变处观测回弹幅度，在线修正压降估计
+static float sagGpsOnMv = 80.0f; // 初值：典型 GPS 负载压降
+static bool lastLoadOn = false;
+static bool haveLastLoad = false;
+static uint16_t mvAtTransition = 0;
+static unsigned long transitionMs = 0;
+static bool sagLearnPending = false;
+
+static float socFiltered = -1.0f;
+
+// GPS 供电中的状态都算高负载（S1/S3/S4/S5）
+static bool gpsLoadOn(uint8_t gpsState) {
+  return gpsState == S1_GPS_SEARCHING_FIX || gpsState == S3_TRACKING_FIXED ||
+         gpsState == S4_ANALYZING_STILLNESS ||
+         gpsState == S5_AGNSS_PROCESSING;
+}
+
+void batteryTelemetryUpdate(uint16_t voltage_mv, uint8_t gpsState) {
+  unsigned long now = millis();
+  bool loadOn = gpsLoadOn(gpsState);
+
+  // 压降学习：记录开→关跃变，回稳后用「静息 - 带载」更新估计
+  if (haveLastLoad && lastLoadOn && !loadOn) {
+    mvAtTransition = voltage_mv;
+    transitionMs = now;
+    sagLearnPending = true;
+  }
+  if (sagLearnPending) {
+    if (loadOn) {
+      sagLearnPending = false; // 负载又回来了，本次观测作废
+    } else if (now - transitionMs >= BATTERY_SAG_SETTLE_MS) {
+      float sample = (float)voltage_mv - (float)mvAtTransition;
+      // 只接受合理范围内的回弹（异常值多半是同时刻的别的负载变化）
+      if (sample > 0.0f && sample < 500.0f) {
+        sagGpsOnMv += (sample - sagGpsOnMv) * 0.25f;
+      }
+      sagLearnPending = false;
+    }
+  }
+  lastLoadOn = loadOn;
+  haveLastLoad = true;
+
+  // 带载电压先抬回静息值再查曲线，SoC 不随 GPS 开关跳变
+  float compMv = loadOn ? (float)voltage_mv + sagGpsOnMv : (float)voltage_mv;
+  float soc = estimateBatteryLevel(compMv);
+  if (socFiltered < 0.0f) {
+    socFiltered = soc;
+  } else {
+    socFiltered += BATTERY_SOC_EMA_ALPHA * (soc - socFiltered);
+  }
+
+  // 抽稀落环
+  static unsigned long lastSampleMs = 0;
+  if (totalCount != 0 &&
+      now - lastSampleMs < BATTERY_TELEMETRY_SAMPLE_INTERVAL_MS) {
+    return;
+  }
+  lastSampleMs = now;
+
+  uint32_t count = totalCount;
+  BatteryTelemetrySample &slot = ring[count % BATTERY_TELEMETRY_CAPACITY];
+  slot.uptime_s = (uint32_t)(now / 1000);
+  slot.voltage_mv = voltage_mv;
+  slot.gpsState = gpsState;
+  slot.soc_pct = batteryTelemetrySocPct();
+  totalCount = count + 1; // 槽位写完再发布
+}
+
+uint8_t batteryTelemetrySocPct() {
+  if (socFiltered < 0.0f) {
+    return 0;
+  }
+  return (uint8_t)(socFiltered + 0.5f);
+}
+
+uint16_t batteryTelemetryCount() {
+  uint32_t c = totalCount;
+  return (c > BATTERY_TELEMETRY_CAPACITY) ? BATTERY_TELEMETRY_CAPACITY
+                                          : (uint16_t)c;
+}
+
+bool batteryTelemetryGet(uint16_t index, BatteryTelemetrySample *out) {
+  if (out == nullptr) {
+    return false;
+  }
+  uint32_t c = totalCount;
+  uint16_t n = (c > BATTERY_TELEMETRY_CAPACITY) ? BATTERY_TELEMETRY_CAPACITY
+                                                : (uint16_t)c;
+  if (index >= n) {
+    return false;
+  }
+  // 最旧条目在 c - n；读取期间生产者最多覆盖掉正在读的最旧一条，
+  // 遥测数据可以容忍这种罕见的单条撕裂
+  *out = ring[(c - n + index) % BATTERY_TELEMETRY_CAPACITY];
+  return true;
+}
@@ -0,0 +1,37 @@
+#ifndef BATTERY_TELEMETRY_H
+#define BATTERY_TELEMETRY_H
+
+#include <stdint.h>
+
+// 电池遥测：定期把「电压 + 当时的 GPS 负载状态 + SoC 估计」存进
+// RAM 环，供 GET_BATTERY_LOG (0x26) 分页导出。SoC 估计做负载补偿：
+// GPS 开机时电压被拉低（内阻压降），在开→关的负载跃变处在线学习
+// 压降幅度，查表前把开机电压抬回静息值，SoC 不再随 GPS 开关跳变。
+//
+// 采样在电池定时器回调（FreeRTOS 定时器任务）里做，导出在主循环，
+// 环用和 AgnssRing 相同的单生产者/单消费者头尾游标约定。
+
+#pragma pack(push, 1)
+struct BatteryTelemetrySample {
+  uint32_t uptime_s;  // 采样时刻（millis/1000）
+  uint16_t voltage_mv; // EMA 滤波后的原始电压
+  uint8_t gpsState;   // 采样时的 GpsState_t
+  uint8_t soc_pct;    // 负载补偿后的 SoC (0-100)
+};
+#pragma pack(pop)
+
+#define BATTERY_TELEMETRY_CAPACITY 256 // 8 字节/条 → 2 KB RAM
+
+// 每次电压读数后调用（电池定时器回调里）；内部按采样间隔抽稀
+void batteryTelemetryUpdate(uint16_t voltage_mv, uint8_t gpsState);
+
+// 当前负载补偿后的 SoC（协议/显示用）
+uint8_t batteryTelemetrySocPct();
+
+// --- 导出接口（GET_BATTERY_LOG 用，主循环侧调用） ---
+// 环内样本总数（最多 BATTERY_TELEMETRY_CAPACITY，旧的被覆盖）
+uint16_t batteryTelemetryCount();
+// 取第 index 条（0 = 最旧）；越界返回 false
+bool batteryTelemetryGet(uint16_t index, BatteryTelemetrySample *out);
+
+#endif // BATTERY_TELEMETRY_H
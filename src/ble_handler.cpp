@@ -1,14 +1,22 @@
 #include "ble_handler.h"
+#include "ble_tx_stream.h"
+#include "config.h"
 #include "file_transfer_protocol.h"
 
 // BLE Services
 BLEDis bledis; // Device Information Service
 BLEUart bleuart;
 // BLEBas blebas; // Battery Service
+// 发送走非阻塞 TX 环（按协商 MTU 打包），读方向透传 bleuart
+static BleTxStream bleTxStream(&bleuart);
 static FileTransferProtocol
-    fileTransferProtocol(&bleuart); // File Transfer Protocol
+    fileTransferProtocol(&bleTxStream); // File Transfer Protocol
 // File transfer state variables (moved to file_transfer_protocol.cpp)
-static uint16_t negotiatedMtuPayloadSize = BLE_DEFAULT_MTU_PAYLOAD;
+
+// 连接参数档位状态：连上默认快档（协商期命令多），传输结束或
+// 链路静默后回慢档省电
+static bool connParamsFast = false;
+static uint32_t lastLinkActivityMs = 0;
 
 // --- Helper Functions ---
 
@@ -18,29 +26,73 @@ void BleHandler::connect_callback(uint16_t conn_handle) {
 
   BLEConnection *conn = Bluefruit.Connection(conn_handle);
   if (conn) {
-    // Adafruit Bluefruit nRF52 library typically negotiates MTU automatically.
-    // Default is often 23 bytes (payload 20). Max can be up to 247 (payload
-    // 244) for nRF52840. We get the negotiated MTU here.
+    // 显式发起 2M PHY / 数据长度扩展 / MTU 协商。不在回调里 delay
+    // 等结果——TX 环发包前每次都查 getMtu()，协商一完成自动用大包
     conn->requestPHY();
     conn->requestDataLengthUpdate();
     conn->requestMtuExchange(247); // Request max MTU
-    delay(1000);                   // Wait for MTU exchange to complete
-    uint16_t mtu = conn->getMtu();
-    negotiatedMtuPayloadSize = mtu - 3; // 3 bytes for ATT header
-    Log.print("BLE: Negotiated MTU:");
-    Log.print(mtu);
-    Log.print("BLE: Negotiated MTU payload size:");
-    Log.print(negotiatedMtuPayloadSize);
   }
+  // 刚连上按快档计（Periph.setConnInterval 的初始参数就是快档），
+  // 静默超时后由 service() 降到慢档
+  connParamsFast = true;
+  lastLinkActivityMs = millis();
 }
 
 void BleHandler::disconnect_callback(uint16_t conn_handle, uint8_t reason) {
   Log.printf("BLE: Client disconnected, conn_handle = %d, reason = 0x%02X",
              conn_handle, reason);
-  negotiatedMtuPayloadSize = BLE_DEFAULT_MTU_PAYLOAD; // Reset to default
+  fileTransferProtocol.stopSysInfoNotify();  // 订阅随连接终止
+  fileTransferProtocol.cancelBulkOffload();  // 裸流随连接终止
+  fileTransferProtocol.releaseSessionBuffers(); // 会话 arena 整区域复位
+}
+
+void BleHandler::service() {
+  if (Bluefruit.connected()) {
+    fileTransferProtocol.serviceSysInfoNotify();
+    fileTransferProtocol.serviceTransfers(); // 续推背压暂停的传输
+    bleTxStream.service();                   // 排空 TX 环
+
+    // 链路静默超时：从快档回落慢档（数据面闲置但还挂着连接的场景）
+    if (connParamsFast &&
+        millis() - lastLinkActivityMs >= BLE_CONN_IDLE_FALLBACK_MS) {
+      requestSlowConnParams();
+    }
+  }
+}
+
+void BleHandler::noteLinkActivity() { lastLinkActivityMs = millis(); }
+
+void BleHandler::requestFastConnParams() {
+  lastLinkActivityMs = millis();
+  if (connParamsFast || !Bluefruit.connected()) {
+    return;
+  }
+  BLEConnection *conn = Bluefruit.Connection(Bluefruit.connHandle());
+  if (conn != nullptr && conn->connected()) {
+    conn->requestConnectionParameter(BLE_CONN_INTERVAL_FAST_UNITS, 0);
+    connParamsFast = true;
+    Log.println("BLE: Requested fast conn params (transfer)");
+  }
 }
 
-void bleuart_rx_callback(uint16_t conn_hdl) { fileTransferProtocol.process(); }
+void BleHandler::requestSlowConnParams() {
+  if (!connParamsFast || !Bluefruit.connected()) {
+    return;
+  }
+  BLEConnection *conn = Bluefruit.Connection(Bluefruit.connHandle());
+  if (conn != nullptr && conn->connected()) {
+    conn->requestConnectionParameter(BLE_CONN_INTERVAL_SLOW_UNITS,
+                                     BLE_CONN_SLOW_SLAVE_LATENCY);
+    connParamsFast = false;
+    Log.println("BLE: Requested slow conn params (idle)");
+  }
+}
+
+void bleuart_rx_callback(uint16_t conn_hdl) {
+  BleHandler::noteLinkActivity();
+  fileTransferProtocol.process();
+  bleTxStream.service(); // 命令响应立即开始发送，不等周期服务
+}
 
 void bleuart_notify_callback(uint16_t conn_hdl, bool enabled) {
   if (enabled) {
@@ -19,6 +19,17 @@ namespace BleHandler {
  */
 bool setup(); // Return bool to indicate success/failure
 
+// 周期服务钩子：驱动文件传输协议里的主动推送（SYSINFO 订阅通知等）。
+// 由主循环的调度任务调用
+void service();
+
+// --- 连接参数档位（传输期快、空闲慢） ---
+// OPEN_FILE 时切快档（7.5-15 ms 间隔），CLOSE_FILE 或链路静默
+// BLE_CONN_IDLE_FALLBACK_MS 后回慢档（200 ms、带从机延迟）
+void requestFastConnParams();
+void requestSlowConnParams();
+void noteLinkActivity(); // 任何命令到达时刷新空闲计时
+
 // BLE Connection Callbacks
 void connect_callback(uint16_t conn_handle);
 void disconnect_callback(uint16_t conn_handle, uint8_t reason);
@@ -0,0 +1,130 @@
+#include "ble_tx_stream.h"
+#include "ble_handler.h"
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <string.h>
+
+// 环的互斥锁（生产者跨 BLE 任务和主循环两个上下文，照 i2c_lock 的做法）
+static SemaphoreHandle_t tx_mutex = NULL;
+
+static void tx_lock_init() {
+  if (tx_mutex == NULL) {
+    tx_mutex = xSemaphoreCreateMutex();
+  }
+}
+
+static void tx_lock() {
+  tx_lock_init();
+  xSemaphoreTake(tx_mutex, portMAX_DELAY);
+}
+
+static void tx_unlock() { xSemaphoreGive(tx_mutex); }
+
+BleTxStream::BleTxStream(BLEUart *inner)
+    : _inner(inner), _head(0), _tail(0), _used(0) {}
+
+uint16_t BleTxStream::mtuPayloadSize() {
+  // 每次发送前查当前连接的协商结果，MTU 交换完成后自动用上大包，
+  // 不需要在 connect 回调里 delay 等待
+  uint16_t conn = Bluefruit.connHandle();
+  BLEConnection *c = Bluefruit.Connection(conn);
+  if (c != nullptr && c->connected()) {
+    uint16_t mtu = c->getMtu();
+    if (mtu > 3) {
+      return mtu - 3; // 3 字节 ATT 头
+    }
+  }
+  return BLE_DEFAULT_MTU_PAYLOAD;
+}
+
+size_t BleTxStream::write(uint8_t b) { return write(&b, 1); }
+
+size_t BleTxStream::write(const uint8_t *buffer, size_t size) {
+  if (buffer == nullptr || size == 0 || size > BLE_TX_RING_SIZE) {
+    return 0;
+  }
+  tx_lock();
+  if (BLE_TX_RING_SIZE - _used < size) {
+    tx_unlock();
+    return 0; // 环放不下整包：背压，调用方稍后重试
+  }
+  size_t firstPart = BLE_TX_RING_SIZE - _tail;
+  if (firstPart >= size) {
+    memcpy(_ring + _tail, buffer, size);
+  } else {
+    memcpy(_ring + _tail, buffer, firstPart);
+    memcpy(_ring, buffer + firstPart, size - firstPart);
+  }
+  _tail = (_tail + size) % BLE_TX_RING_SIZE;
+  _used += size;
+  tx_unlock();
+  return size;
+}
+
+size_t BleTxStream::service() {
+  if (_used == 0 || !Bluefruit.connected()) {
+    return 0;
+  }
+  uint16_t mtuPayload = mtuPayloadSize();
+  uint8_t packet[247]; // 最大 MTU 载荷（nRF52840 上限 244 + 余量）
+  if (mtuPayload > sizeof(packet)) {
+    mtuPayload = sizeof(packet);
+  }
+
+  size_t sent = 0;
+  for (;;) {
+    tx_lock();
+    size_t chunk = (_used < mtuPayload) ? _used : mtuPayload;
+    if (chunk == 0) {
+      tx_unlock();
+      break;
+    }
+    // 先拷出再发，发送成功才出环（失败时数据不丢）
+    size_t firstPart = BLE_TX_RING_SIZE - _head;
+    if (firstPart >= chunk) {
+      memcpy(packet, _ring + _head, chunk);
+    } else {
+      memcpy(packet, _ring + _head, firstPart);
+      memcpy(packet + firstPart, _ring, chunk - firstPart);
+    }
+    tx_unlock();
+
+    size_t written = _inner->write(packet, chunk);
+    if (written == 0) {
+      break; // SoftDevice 发送队列满，下次 service 再续
+    }
+
+    tx_lock();
+    _head = (_head + written) % BLE_TX_RING_SIZE;
+    _used -= written;
+    tx_unlock();
+    sent += written;
+    if (written < chunk) {
+      break; // 只收了一部分，队列已接近满
+    }
+  }
+  return sent;
+}
+
+int BleTxStream::availableForWrite() {
+  tx_lock();
+  int freeBytes = (int)(BLE_TX_RING_SIZE - _used);
+  tx_unlock();
+  return freeBytes;
+}
+
+size_t BleTxStream::pendingBytes() {
+  tx_lock();
+  size_t used = _used;
+  tx_unlock();
+  return used;
+}
+
+int BleTxStream::available() { return _inner->available(); }
+int BleTxStream::read() { return _inner->read(); }
+int BleTxStream::peek() { return _inner->peek(); }
+
+void BleTxStream::flush() {
+  // 尽力而为：发一轮就走，绝不等待队列排空
+  service();
+}
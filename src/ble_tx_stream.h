@@ -0,0 +1,55 @@
+#ifndef BLE_TX_STREAM_H
+#define BLE_TX_STREAM_H
+
+#include <Arduino.h>
+#include <bluefruit.h>
+
+// NUS 发送端的非阻塞缓冲流。
+//
+// 直接往 BLEUart 写，SoftDevice 发送队列满时会阻塞 loop；这里改成
+// 响应先进一个静态字节环（write() 满了就少收或不收——这是给协议层
+// 的背压信号，不忙等），service() 再按协商出的最大 MTU 把环里的数
+// 据打包成尽量大的 notification 发出去。发送失败（SoftDevice 队列
+// 满）立即停，留到下一次 service，CPU 不空转。
+//
+// 读方向直接透传内层 BLEUart，协议层无感知。
+//
+// 生产者可能在 BLE 任务（RX 回调里的命令响应）和主循环（订阅推送）
+// 两个上下文，入环/出环都拿同一把互斥锁（照 i2c_lock 的做法）。
+
+#define BLE_TX_RING_SIZE 2048
+
+class BleTxStream : public Stream {
+public:
+  explicit BleTxStream(BLEUart *inner);
+
+  // 把环里的数据按 MTU 切包发出。预算内发不完就留着，绝不阻塞。
+  // 返回本次发出的字节数
+  size_t service();
+
+  // 协议层背压探询：环里还能一次性放下多少字节
+  int availableForWrite() override;
+
+  // --- Print/Stream 接口 ---
+  size_t write(uint8_t b) override;
+  // 整包入环：空间不够时一个字节都不收（响应帧不能只发一半），
+  // 返回 0 作为背压信号
+  size_t write(const uint8_t *buffer, size_t size) override;
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush() override; // 尽力 service 一轮，不等待
+
+  size_t pendingBytes();
+
+private:
+  BLEUart *_inner;
+  uint8_t _ring[BLE_TX_RING_SIZE];
+  size_t _head; // 读偏移
+  size_t _tail; // 写偏移
+  size_t _used;
+
+  uint16_t mtuPayloadSize(); // 当前连接协商出的载荷上限
+};
+
+#endif // BLE_TX_STREAM_H
@@ -1,16 +1,30 @@
 #include "bmp280_handler.h"
+#include "config.h"
 #include "i2c_lock.h"
 #include "logger.h"
+#include "power_tier.h"
 
 BMP280Handler bmp280Handler;
 
 BMP280Handler::BMP280Handler()
-    : ok(false), lastAltitude(0), lastTemperature(0), lastPressure(0) {}
+    : ok(false), lastAltitude(0), lastTemperature(0), lastPressure(0),
+      lastReadMs(0) {}
 
 bool BMP280Handler::begin(uint8_t addr) {
   {
     I2C_LockGuard lock;
     ok = bmp280.begin(addr);
+    if (ok) {
+      // 让芯片在 NORMAL 模式下自转：硬件过采样 + IIR 滤波 + 待机周期，
+      // CPU 只在有新转换完成时读结果。参数取 Bosch 的"室内导航"配置
+      // （压力 x16 / 温度 x2 / IIR x16），海拔噪声由硬件滤掉，
+      // 不再需要 CPU 侧平滑
+      bmp280.setSampling(Adafruit_BMP280::MODE_NORMAL,
+                         Adafruit_BMP280::SAMPLING_X2,  // 温度
+                         Adafruit_BMP280::SAMPLING_X16, // 压力
+                         Adafruit_BMP280::FILTER_X16,
+                         Adafruit_BMP280::STANDBY_MS_500);
+    }
   }
   if (ok) {
     Log.println("BMP280 初始化成功");
@@ -25,12 +39,29 @@ void BMP280Handler::update() { updateInternal(); }
 void BMP280Handler::updateInternal() {
   if (!ok)
     return;
+
+  // 一个待机周期内不会有新转换，直接跳过，连状态字节都不读。
+  // 空闲档（S2/S4 静止）拉长到 BMP280_IDLE_INTERVAL_MS：芯片继续
+  // 自转，只是主机少去读它
+  unsigned long interval = (currentPowerTier() == POWER_TIER_IDLE)
+                               ? BMP280_IDLE_INTERVAL_MS
+                               : BMP280_STANDBY_INTERVAL_MS;
+  unsigned long now = millis();
+  if (lastReadMs != 0 && now - lastReadMs < interval) {
+    return;
+  }
+
   {
     I2C_LockGuard lock;
+    // 状态寄存器 bit3 = 正在转换；转换中不读，等下一轮
+    if (bmp280.getStatus() & 0x08) {
+      return;
+    }
     lastTemperature = bmp280.readTemperature();
     lastPressure = bmp280.readPressure();
     lastAltitude = bmp280.readAltitude(1017.9); // 标准大气压
   }
+  lastReadMs = now;
   // Log.print("[BMP280] 温度: ");
   // Log.print(lastTemperature);
   // Log.print(" C, 气压: ");
@@ -21,6 +21,7 @@ private:
   float lastAltitude;
   float lastTemperature;
   float lastPressure;
+  unsigned long lastReadMs; // 上次成功读取的时刻（待机周期节流用）
 };
 
 extern BMP280Handler bmp280Handler;
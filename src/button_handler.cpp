@@ -4,56 +4,143 @@
 #include "gps_handler.h"     // For resetting GPS update timer
 #include "sd_handler.h"
 #include "logger.h"
-#include "utility/AdaCallback.h" // For ada_callback_fromISR
 #include <Arduino.h>
 #include <bluefruit.h>
 
-// Button state variables
-static unsigned long lastValidInterruptTime = 0; // ADDED
-bool currentButtonState = HIGH;                  // Debounced state
-unsigned long pressStartTime =
-    0; // Time when the button press started (after debounce)
-bool actionTriggeredForPress =
-    false; // Flag to ensure action triggers only once per press
+// --- ISR 侧：双边沿事件环 ---------------------------------------------
+// ISR 是唯一生产者（写 _tail），serviceButton 是唯一消费者（写 _head），
+// 与 AgnssRing 相同的单生产者/单消费者约定，无需关中断。
+// 16 个槽位对按键来说绰绰有余；满了就丢弃并计数（分类器会在下次
+// 稳定电平时自行回到一致状态）。
 
-void switchISR() { ada_callback(NULL, 0, handleButton); }
+struct ButtonEdge {
+  uint32_t ms;   // millis() 时间戳
+  uint8_t level; // 触发后的电平（LOW = 按下，内部上拉）
+};
+
+#define BUTTON_EVENT_RING_SIZE 16 // 必须是 2 的幂
+
+static ButtonEdge edgeRing[BUTTON_EVENT_RING_SIZE];
+static volatile uint8_t edgeHead = 0; // 消费者游标
+static volatile uint8_t edgeTail = 0; // 生产者游标
+static volatile uint16_t edgeDropped = 0;
+
+static void buttonEdgeISR() {
+  uint8_t tail = edgeTail;
+  uint8_t next = (tail + 1) & (BUTTON_EVENT_RING_SIZE - 1);
+  if (next == edgeHead) {
+    edgeDropped = edgeDropped + 1; // 环满，丢弃本次边沿
+    return;
+  }
+  edgeRing[tail].ms = millis();
+  edgeRing[tail].level = (uint8_t)digitalRead(BUTTON_PIN);
+  edgeTail = next; // 数据就绪后再发布
+}
+
+// --- 主循环侧：去抖 + 分类 --------------------------------------------
+
+static uint8_t debouncedLevel = HIGH; // 去抖后的电平
+static uint32_t lastEdgeMs = 0;       // 上次接受的边沿时刻
+static uint32_t pressStartMs = 0;     // 当前按下的起始时刻
+static uint32_t lastReleaseMs = 0;    // 上次短按释放时刻
+static uint8_t pendingClicks = 0;     // 等待连按窗口结束的短按数
+static bool holdFired = false;        // 本次按下是否已触发长按
 
 void initButton() {
   pinMode(BUTTON_PIN, INPUT_PULLUP);
+  debouncedLevel = (uint8_t)digitalRead(BUTTON_PIN);
   Log.println("Button Pin Initialized");
-  attachInterrupt(BUTTON_PIN, switchISR, FALLING);
+  attachInterrupt(BUTTON_PIN, buttonEdgeISR, CHANGE);
 }
 
-void onButtonPushed() {
-  Log.println("Button Held Action Triggered!");
-  Bluefruit.Advertising.setFastTimeout(5);
-  Bluefruit.Advertising.start(5);
-  
-  // 立即flush缓存数据到SD卡
-  extern bool flushCacheToSD();
-  if (flushCacheToSD()) {
-    Log.println("Cache flushed to SD card successfully");
+void onButtonClick(uint8_t clickCount) {
+  if (clickCount == 1) {
+    // 单击：沿用原有动作（BLE 快速广播 + 落盘 + 显示切换）
+    Log.println("Button Click Action Triggered!");
+    Bluefruit.Advertising.setFastTimeout(5);
+    Bluefruit.Advertising.start(5);
+
+    // 立即flush缓存数据到SD卡
+    extern bool flushCacheToSD();
+    if (flushCacheToSD()) {
+      Log.println("Cache flushed to SD card successfully");
+    } else {
+      Log.println("Failed to flush cache to SD card");
+    }
+
+    listSDRootContents(); // List SD card files on button press
+    resetDisplayTimeout();       // Reset display timeout
+    toggleDisplay();             // Toggle display on press
   } else {
-    Log.println("Failed to flush cache to SD card");
+    // 双击/三击：外勤快捷键位，动作待分配
+    Log.printf("Button %d-click detected (unassigned)\n", clickCount);
   }
-  
-  listSDRootContents(); // List SD card files on button press
-  resetDisplayTimeout();       // Reset display timeout
-  toggleDisplay();             // Toggle display on press
 }
 
-// Function to handle button press with debounce and hold duration requirement
-void handleButton() {
-  unsigned long currentTime = millis();
+void onButtonHold() {
+  // 长按快捷键位，动作待分配（按住即触发，无需等松手）
+  Log.println("Button hold detected (unassigned)");
+}
 
-  // New debounce logic: if an interrupt occurs too soon after the last one
-  // that was allowed to proceed, ignore this current interrupt.
-  if (currentTime - lastValidInterruptTime < DEBOUNCE_DELAY) {
-    return; // Ignore this interrupt
+// 处理一个去抖后的有效边沿
+static void applyEdge(uint32_t ms, uint8_t level) {
+  debouncedLevel = level;
+  if (level == LOW) {
+    pressStartMs = ms;
+    holdFired = false;
+  } else {
+    if (!holdFired) {
+      uint32_t duration = ms - pressStartMs;
+      if (duration >= BUTTON_HOLD_MS) {
+        // 兜底：长按的时间阈值以事件时间戳为准
+        onButtonHold();
+        holdFired = true;
+      } else {
+        if (pendingClicks < 255) {
+          pendingClicks++;
+        }
+        lastReleaseMs = ms;
+      }
+    }
+    // 长按已触发的那次松手不算短按
   }
-  // This interrupt is not being ignored due to rate-limiting.
-  // Mark this time as the last time an interrupt was processed.
-  lastValidInterruptTime = currentTime;
+}
+
+void serviceButton() {
+  // 1) 排空事件环：同电平重复边沿和去抖窗口内的毛刺直接丢弃
+  while (edgeHead != edgeTail) {
+    uint8_t head = edgeHead;
+    ButtonEdge ev = edgeRing[head];
+    edgeHead = (head + 1) & (BUTTON_EVENT_RING_SIZE - 1);
+
+    if (ev.level == debouncedLevel) {
+      continue; // 毛刺抖回了原电平
+    }
+    if ((uint32_t)(ev.ms - lastEdgeMs) < DEBOUNCE_DELAY) {
+      continue;
+    }
+    lastEdgeMs = ev.ms;
+    applyEdge(ev.ms, ev.level);
+  }
+
+  uint32_t now = millis();
 
-  onButtonPushed();
+  // 2) 按住即触发长按，不等松手
+  if (debouncedLevel == LOW && !holdFired &&
+      (uint32_t)(now - pressStartMs) >= BUTTON_HOLD_MS) {
+    onButtonHold();
+    holdFired = true;
+  }
+
+  // 3) 连按窗口关闭后再派发，单击/双击才能区分开
+  if (pendingClicks > 0 && debouncedLevel == HIGH &&
+      (uint32_t)(now - lastReleaseMs) >= BUTTON_MULTI_PRESS_GAP_MS) {
+    onButtonClick(pendingClicks);
+    pendingClicks = 0;
+  }
+
+  if (edgeDropped > 0) {
+    Log.printf("Button event ring overflow, dropped %d edges\n", edgeDropped);
+    edgeDropped = 0;
+  }
 }
@@ -3,14 +3,19 @@
 
 #include <Arduino.h>
 
+// 按键处理：GPIO 双边沿中断只负责把「电平 + 时间戳」写进小事件环
+// （ISR 是唯一生产者），去抖/长按/连按分类全部在主循环的
+// serviceButton() 里对排好队的事件做。按下时刻不再被 SD 刷写等
+// 慢任务吞掉，短按也不依赖轮询间隔。
+
 // Function to initialize the button pin
 void initButton();
 
-// Function to handle button press with debounce and hold duration requirement
-void handleButton();
+// 周期任务：排空事件环并分类（由调度器调用，见 main.cpp）
+void serviceButton();
 
-// Function called when a valid button hold is detected (needs to be implemented
-// by user or here)
-void onButtonPushed();
+// 分类结果回调（主循环上下文，不在 ISR 里）
+void onButtonClick(uint8_t clickCount); // 短按；clickCount = 连按次数
+void onButtonHold();                    // 按住超过 BUTTON_HOLD_MS
 
 #endif // BUTTON_HANDLER_H
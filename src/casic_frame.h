@@ -0,0 +1,162 @@
+#ifndef CASIC_FRAME_H
+#define CASIC_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 出站 CASIC 帧的编译期构造器。
+//
+// 固定载荷的命令（唤醒、配置、AID-INI 请求等）整帧——头部、长度、
+// 载荷、校验和——全部在编译期算好放进 flash，发送就是一次
+// write(frame.bytes, sizeof(frame.bytes))，运行时零组帧开销；
+// 变长命令用 buildFrame()，头部字节直接落缓冲，只对载荷区做
+// 运行时校验和累加。
+//
+// 帧格式: BA CE [len:2 LE] [class] [id] [payload] [cksum:4 LE]
+// 校验和: (id<<24) + (class<<16) + len，再累加载荷按 32 位小端字
+// （与 casic_gps_wrapper 的接收侧算法一致，尾部不足 4 字节补零）。
+//
+// 注意保持 C++11 兼容（Arduino 核心默认 gnu++11）：constexpr 只用
+// 单表达式递归，索引序列自备。
+
+namespace casic {
+
+// --- C++11 下自备的 index_sequence ---
+template <uint16_t... I> struct IndexSeq {};
+template <uint16_t N, uint16_t... I>
+struct MakeSeq : MakeSeq<N - 1, N - 1, I...> {};
+template <uint16_t... I> struct MakeSeq<0, I...> {
+  typedef IndexSeq<I...> type;
+};
+
+// 完整帧（含 10 字节固定开销），可放 constexpr/.rodata
+template <uint16_t N> struct Frame {
+  uint8_t bytes[10 + N];
+};
+
+constexpr uint16_t frameSize(uint16_t payloadLen) { return payloadLen + 10; }
+
+// --- 校验和（编译期/运行期通用） ---
+
+constexpr uint32_t payloadByte(const uint8_t *p, uint16_t len, uint16_t i) {
+  return i < len ? p[i] : 0; // 尾部补零
+}
+
+constexpr uint32_t payloadWord(const uint8_t *p, uint16_t len, uint16_t i) {
+  return payloadByte(p, len, i) | (payloadByte(p, len, i + 1) << 8) |
+         (payloadByte(p, len, i + 2) << 16) |
+         (payloadByte(p, len, i + 3) << 24);
+}
+
+constexpr uint32_t sumPayloadWords(const uint8_t *p, uint16_t len,
+                                   uint16_t i = 0) {
+  return i >= len ? 0 : payloadWord(p, len, i) + sumPayloadWords(p, len, i + 4);
+}
+
+// 头部三个字段的校验和种子：变长命令可复用（头部不变时只需
+// 累加载荷区）
+constexpr uint32_t checksumSeed(uint8_t cls, uint8_t id, uint16_t len) {
+  return ((uint32_t)id << 24) + ((uint32_t)cls << 16) + len;
+}
+
+constexpr uint32_t checksum(uint8_t cls, uint8_t id, const uint8_t *p,
+                            uint16_t len) {
+  return checksumSeed(cls, id, len) + sumPayloadWords(p, len);
+}
+
+// --- 编译期组帧 ---
+
+template <uint16_t N>
+constexpr uint8_t frameByte(uint8_t cls, uint8_t id, const uint8_t (&p)[N],
+                            uint32_t ck, uint16_t i) {
+  return i == 0   ? 0xBA
+         : i == 1 ? 0xCE
+         : i == 2 ? (uint8_t)(N & 0xFF)
+         : i == 3 ? (uint8_t)(N >> 8)
+         : i == 4 ? cls
+         : i == 5 ? id
+         : i < 6 + N
+             ? p[i - 6]
+             : (uint8_t)(ck >> (8 * (i - (uint16_t)(6 + N))));
+}
+
+template <uint16_t N, uint16_t... I>
+constexpr Frame<N> makeFrameImpl(uint8_t cls, uint8_t id,
+                                 const uint8_t (&p)[N], uint32_t ck,
+                                 IndexSeq<I...>) {
+  return Frame<N>{{frameByte<N>(cls, id, p, ck, I)...}};
+}
+
+// 固定载荷命令：constexpr auto f = casic::makeFrame(cls, id, payload);
+template <uint16_t N>
+constexpr Frame<N> makeFrame(uint8_t cls, uint8_t id, const uint8_t (&p)[N]) {
+  return makeFrameImpl(cls, id, p, checksum(cls, id, p, N),
+                       typename MakeSeq<10 + N>::type());
+}
+
+// 无载荷命令（查询/轮询类）
+constexpr Frame<0> makeFrame(uint8_t cls, uint8_t id) {
+  return Frame<0>{{0xBA, 0xCE, 0, 0, cls, id,
+                   (uint8_t)(checksumSeed(cls, id, 0)),
+                   (uint8_t)(checksumSeed(cls, id, 0) >> 8),
+                   (uint8_t)(checksumSeed(cls, id, 0) >> 16),
+                   (uint8_t)(checksumSeed(cls, id, 0) >> 24)}};
+}
+
+// --- 运行期组帧（变长载荷） ---
+// 头部/尾部直接写入，校验和 = 编译期可算的种子 + 载荷区单遍累加。
+// 返回帧总长，缓冲不足返回 0。
+inline uint16_t buildFrame(uint8_t cls, uint8_t id, const uint8_t *payload,
+                           uint16_t len, uint8_t *out, uint16_t cap) {
+  uint16_t total = frameSize(len);
+  if (out == nullptr || cap < total || (payload == nullptr && len > 0)) {
+    return 0;
+  }
+  out[0] = 0xBA;
+  out[1] = 0xCE;
+  out[2] = (uint8_t)(len & 0xFF);
+  out[3] = (uint8_t)(len >> 8);
+  out[4] = cls;
+  out[5] = id;
+  uint32_t ck = checksumSeed(cls, id, len);
+  uint16_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    uint32_t word = (uint32_t)payload[i] | ((uint32_t)payload[i + 1] << 8) |
+                    ((uint32_t)payload[i + 2] << 16) |
+                    ((uint32_t)payload[i + 3] << 24);
+    ck += word;
+    out[6 + i] = payload[i];
+    out[6 + i + 1] = payload[i + 1];
+    out[6 + i + 2] = payload[i + 2];
+    out[6 + i + 3] = payload[i + 3];
+  }
+  if (i < len) { // 尾部不足一个字，补零参与校验
+    uint32_t word = 0;
+    for (uint16_t j = 0; i + j < len; j++) {
+      word |= (uint32_t)payload[i + j] << (8 * j);
+      out[6 + i + j] = payload[i + j];
+    }
+    ck += word;
+  }
+  out[6 + len] = (uint8_t)(ck);
+  out[6 + len + 1] = (uint8_t)(ck >> 8);
+  out[6 + len + 2] = (uint8_t)(ck >> 16);
+  out[6 + len + 3] = (uint8_t)(ck >> 24);
+  return total;
+}
+
+// --- 编译期自检 ---
+// 种子即无载荷帧的校验和：AID-INI 轮询帧 (0x0B, 0x01, len 0)
+static_assert(checksumSeed(0x0B, 0x01, 0) == 0x010B0000UL,
+              "CASIC checksum seed mismatch");
+// 已知向量：载荷 {01 00 00 00}，单字累加
+namespace detail_selftest {
+constexpr uint8_t kProbe[4] = {0x01, 0x00, 0x00, 0x00};
+static_assert(checksum(0x06, 0x01, kProbe, 4) == 0x01060004UL + 0x00000001UL,
+              "CASIC payload checksum mismatch");
+static_assert(sizeof(Frame<4>) == 14, "CASIC frame layout mismatch");
+} // namespace detail_selftest
+
+} // namespace casic
+
+#endif // CASIC_FRAME_H
@@ -35,6 +35,61 @@ bool CasicGpsWrapper::encode(uint8_t byte) {
   return _tinyGPS.encode(byte);
 }
 
+bool CasicGpsWrapper::processBuffer(const uint8_t *data, size_t length) {
+  // 输入必须是一个完整的帧：BA CE [len:2] [class] [id] [payload] [cksum:4]
+  if (data == nullptr || length < 10 || data[0] != CASIC_HEADER_1 ||
+      data[1] != CASIC_HEADER_2) {
+    return false;
+  }
+
+  uint16_t payloadLength = (uint16_t)data[2] | ((uint16_t)data[3] << 8);
+  if (payloadLength > CASIC_MAX_PAYLOAD_SIZE ||
+      length != (size_t)payloadLength + 10) {
+    return false;
+  }
+
+  // 批量路径和逐字节状态机共用 _currentPacket，先把残留状态清掉
+  resetParser();
+
+  _currentPacket.payload_length = payloadLength;
+  _currentPacket.class_id = data[4];
+  _currentPacket.msg_id = data[5];
+
+  // 单遍：拷贝载荷的同时按32位小端字增量累加校验和，
+  // 不再对缓冲区做第二遍校验和扫描。
+  // memcpy 读字在 Cortex-M4 上编译成单条 ldr（允许非对齐访问）。
+  uint32_t checksum = ((uint32_t)_currentPacket.msg_id << 24) +
+                      ((uint32_t)_currentPacket.class_id << 16) +
+                      payloadLength;
+  const uint8_t *payload = data + 6;
+  uint16_t payloadWords = payloadLength / 4;
+  for (uint16_t i = 0; i < payloadWords; i++) {
+    uint32_t word;
+    memcpy(&word, payload + i * 4, 4); // 小端平台，直接按字取
+    checksum += word;
+    memcpy(_currentPacket.payload + i * 4, &word, 4);
+  }
+  // CASIC载荷长度总是4的倍数；防御性拷贝可能的尾部残字节（不计入校验和）
+  if (payloadLength & 3) {
+    memcpy(_currentPacket.payload + payloadWords * 4, payload + payloadWords * 4,
+           payloadLength & 3);
+  }
+
+  _currentPacket.calculated_checksum = checksum;
+  memcpy(&_currentPacket.checksum, data + 6 + payloadLength, 4);
+  _currentPacket.valid =
+      (_currentPacket.checksum == _currentPacket.calculated_checksum);
+
+  if (_currentPacket.valid) {
+    _currentPacket.timestamp = millis();
+    _lastValidPacket = _currentPacket;
+    _newCasicData = true;
+  }
+  bool valid = _currentPacket.valid;
+  resetParser();
+  return valid;
+}
+
 bool CasicGpsWrapper::processCasicByte(uint8_t byte) {
   unsigned long currentTime = millis();
 
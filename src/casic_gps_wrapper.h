@@ -80,6 +80,10 @@ public:
 
   // 主要接口
   bool encode(uint8_t byte); // 处理单个字节（兼容TinyGPS++接口）
+  // 批量处理一个完整的CASIC帧（BA CE ... 校验和，由解复用器切好）。
+  // 单遍完成载荷拷贝和按32位字的增量校验和累加，比逐字节状态机
+  // 快一个数量级，S5注入时用。返回true表示帧校验通过。
+  bool processBuffer(const uint8_t *data, size_t length);
   TinyGPSPlus &getTinyGPS(); // 获取内部TinyGPS++实例
 
   // CASIC相关接口
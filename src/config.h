@@ -10,6 +10,9 @@
 #define SCREEN_ADDRESS 0x3C // I2C address for 128x64 SSD1306
 #define DISPLAY_TIMEOUT_MS                                                     \
   30000 // Auto screen off timeout in milliseconds (30 seconds)
+// 空闲档（S2/S4，见 power_tier.h）下的熄屏超时：静止时没人看屏幕，
+// 提前关掉 OLED 和它的刷新流量
+#define DISPLAY_TIMEOUT_IDLE_MS 10000
 
 // GPS settings
 #define GPS_SERIAL Serial1 // HardwareSerial port for GPS (e.g., Serial1)
@@ -26,7 +29,21 @@ const unsigned long GPS_NO_FIX_MSG_INTERVAL =
 // boards) If not defined in variant.h, define it here: #define BUTTON_PIN
 // YOUR_BUTTON_PIN_NUMBER
 const unsigned long DEBOUNCE_DELAY = 50; // Debounce time in milliseconds
-const unsigned long HOLD_DURATION = 50;  // Required hold duration in ms
+// 按键手势分类阈值（serviceButton 对事件队列做分类，见 button_handler.cpp）
+#define BUTTON_HOLD_MS 800           // 按住超过此时长算长按
+#define BUTTON_MULTI_PRESS_GAP_MS 300 // 连按窗口：松手后等下一次按下的间隔
+
+// BMP280 NORMAL 模式的待机周期（与 setSampling 的 STANDBY_MS_500 对应，
+// update() 在一个周期内不重复发起 I2C 事务）
+#define BMP280_STANDBY_INTERVAL_MS 500
+// 空闲档下的读取周期：静止时海拔不变，10 秒读一次足够维持
+// 气压/GPS 融合的标定，I2C 流量降到 1/20
+#define BMP280_IDLE_INTERVAL_MS 10000
+
+// 气压/GPS 海拔融合（altitude_fusion.cpp）
+#define ALTITUDE_FUSION_CALIB_VALID_MS (2UL * 60 * 60 * 1000) // 标定有效期
+#define ALTITUDE_FUSION_LOG_THRESHOLD_CM 200   // 海拔变化超过 2 m 才落盘
+#define ALTITUDE_FUSION_MIN_LOG_INTERVAL_MS (30UL * 1000) // 落盘最小间隔
 
 // GPS Power and Timing Settings
 const unsigned long GPS_FIX_INTERVAL =
@@ -56,6 +73,28 @@ const unsigned long GPS_FIX_ATTEMPT_TIMEOUT =
 // or S2_IDLE_GPS_OFF to wait for motion or periodic wake.
 #define GPS_INITIAL_STATE_AFTER_INIT S2_IDLE_GPS_OFF
 
+// --- SD Write Cache Settings ---
+// 写缓存加大后，缓存半满由空闲钩子 (serviceSDCacheFlush) 触发写入，
+// 写入量对齐到扇区边界，减少卡内部的读-改-写放大（延长卡寿命）。
+#define SD_WRITE_CACHE_SIZE (16 * 1024)      // 写缓存总大小
+#define SD_CACHE_FLUSH_WATERMARK (8 * 1024)  // 空闲钩子触发写入的水位
+#define SD_ERASE_ALIGN_BYTES 512             // 写入对齐单位（扇区）
+#define SD_FLUSH_BUDGET_MS 10                // 每次空闲冲刷的时间预算
+
+// --- Accelerometer (LIS3DHTR) Settings ---
+// 运动唤醒中断引脚（LIS3DHTR INT1 -> MCU）。板子没接时保持注释，
+// S2 下会退回轮询模式
+// #define PIN_ACCEL_INT YOUR_ACCEL_INT_PIN
+#define ACCEL_WAKE_THRESHOLD_LSB 6 // 2g量程下16mg/LSB，约0.1g
+#define ACCEL_WAKE_DURATION_LSB 1  // 1/ODR，50Hz下20ms
+
+// --- BLE Connection Parameter Tiers ---
+// 传输档/空闲档连接间隔（1.25ms 单位）与空闲回落超时
+#define BLE_CONN_INTERVAL_FAST_UNITS 12  // 15 ms，文件传输期
+#define BLE_CONN_INTERVAL_SLOW_UNITS 160 // 200 ms，空闲连接
+#define BLE_CONN_SLOW_SLAVE_LATENCY 4    // 慢档允许跳过 4 个间隔
+#define BLE_CONN_IDLE_FALLBACK_MS (10 * 1000) // 链路静默回落慢档
+
 // LittleFS settings
 #define MAX_FILE_SIZE                                                          \
   1024 * 1024 * 1024 // Maximum total file size in bytes (1 GB)
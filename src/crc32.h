@@ -0,0 +1,18 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 标准 CRC-32 (IEEE 802.3, 反射, 多项式 0xEDB88320)。
+// 与 Python zlib.crc32 / 前端 CRC-32 实现结果一致。
+
+// 增量计算：crc 传入上一次的返回值，首次传 0。
+uint32_t crc32_update(uint32_t crc, const void *data, size_t length);
+
+// 一次性计算整块数据的 CRC32
+static inline uint32_t crc32_calc(const void *data, size_t length) {
+  return crc32_update(0, data, length);
+}
+
+#endif // CRC32_H
@@ -3,6 +3,7 @@
 #include "config.h"
 #include "i2c_lock.h"
 #include "logger.h"
+#include "power_tier.h"
 #include "system_info.h" // Include global system info
 #include <Arduino.h>     // For Log
 #include <Wire.h>        // Include Wire for display
@@ -10,6 +11,147 @@
 // Define the display object
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 
+// 上一次推送到屏幕的帧（脏区 diff 的基准）。GFX 的绘制都在
+// display 的离屏缓冲里完成，flushDirtyFrame() 只把和上一帧不同的
+// 列区间发上总线，而不是每次整推 1KB（400kHz 下整帧约 25ms 总线占用）
+static uint8_t lastSentFrame[SCREEN_WIDTH * SCREEN_HEIGHT / 8];
+static bool lastFrameValid = false;
+
+// 每次 I2C 事务的数据字节数（nRF52 Wire 缓冲 64 字节，留出控制字节）
+#define DISPLAY_I2C_CHUNK 32
+
+// 把离屏缓冲里一个页的 [colStart, colEnd] 列区间发给 SSD1306
+static void sendPageColumns(uint8_t page, uint8_t colStart, uint8_t colEnd,
+                            const uint8_t *frame) {
+  // 设置窗口：单页 + 列区间（初始化时已是水平寻址模式）
+  display.ssd1306_command(SSD1306_PAGEADDR);
+  display.ssd1306_command(page);
+  display.ssd1306_command(page);
+  display.ssd1306_command(SSD1306_COLUMNADDR);
+  display.ssd1306_command(colStart);
+  display.ssd1306_command(colEnd);
+
+  const uint8_t *src = frame + page * SCREEN_WIDTH + colStart;
+  uint16_t remaining = (uint16_t)(colEnd - colStart + 1);
+  while (remaining > 0) {
+    uint8_t n = (remaining > DISPLAY_I2C_CHUNK) ? DISPLAY_I2C_CHUNK
+                                                : (uint8_t)remaining;
+    Wire.beginTransmission(SCREEN_ADDRESS);
+    Wire.write((uint8_t)0x40); // Co=0, D/C=1: 数据流
+    Wire.write(src, n);
+    Wire.endTransmission();
+    src += n;
+    remaining -= n;
+    // 传感器在等总线就先让：下一段数据从新的窗口地址续传即可
+    i2c_yield_point(I2C_PRIO_LOW);
+  }
+}
+
+// 把离屏缓冲与上一帧做逐页 diff，只推送脏的列区间。
+// forceFull 时整帧推送（首帧、开关屏后屏上内容未知时用）
+static void flushDirtyFrame(bool forceFull = false) {
+  const uint8_t *frame = display.getBuffer();
+
+  for (uint8_t page = 0; page < SCREEN_HEIGHT / 8; page++) {
+    const uint8_t *cur = frame + page * SCREEN_WIDTH;
+    uint8_t *last = lastSentFrame + page * SCREEN_WIDTH;
+
+    int16_t dirtyStart = -1, dirtyEnd = -1;
+    if (forceFull || !lastFrameValid) {
+      dirtyStart = 0;
+      dirtyEnd = SCREEN_WIDTH - 1;
+    } else {
+      // 找本页第一列和最后一列的差异（典型更新只动几列）
+      for (int16_t col = 0; col < SCREEN_WIDTH; col++) {
+        if (cur[col] != last[col]) {
+          dirtyStart = col;
+          break;
+        }
+      }
+      if (dirtyStart < 0) {
+        continue; // 本页干净
+      }
+      for (int16_t col = SCREEN_WIDTH - 1; col >= dirtyStart; col--) {
+        if (cur[col] != last[col]) {
+          dirtyEnd = col;
+          break;
+        }
+      }
+    }
+
+    sendPageColumns(page, (uint8_t)dirtyStart, (uint8_t)dirtyEnd, frame);
+    memcpy(last + dirtyStart, cur + dirtyStart, dirtyEnd - dirtyStart + 1);
+  }
+  lastFrameValid = true;
+}
+
+// --- 字形缓存 + 定宽直写排版 ---
+//
+// GFX 的 drawChar 每个像素都要过 drawPixel 的旋转/裁剪分支，整屏
+// 文本重排一次要毫秒级，而屏上内容 99% 是每帧不变的标签和定宽数
+// 字。这里在启动时用 GFX 自己的字体把可打印 ASCII 逐字符栅格化一
+// 次，存成 SSD1306 页格式的列字节（5 字节/字形 + 1 列间距），之后
+// 的刷新全部通过 blitCell 直接 memcpy 进离屏缓冲：整帧排版从毫秒
+// 降到微秒，且输出与 GFX 逐像素画的完全一致（字形就是它画的）。
+// 不再每帧 clearDisplay：标签只在开屏后画一次，数字字段是定宽单
+// 元格，空格填充自擦除。
+#define GLYPH_FIRST 0x20
+#define GLYPH_COUNT 95 // 0x20 - 0x7E
+#define GLYPH_W 6      // 5 列字形 + 1 列间距
+static uint8_t glyphCache[GLYPH_COUNT][5];
+static bool glyphCacheValid = false;
+static bool staticLabelsDrawn = false;
+
+// 用 GFX 把每个字符画进离屏缓冲一次，抠出列字节。只在启动时跑
+// （约 1ms，纯内存操作），缓冲内容会被破坏，调用方之后要重画
+static void buildGlyphCache() {
+  for (uint8_t i = 0; i < GLYPH_COUNT; i++) {
+    display.clearDisplay();
+    display.drawChar(0, 0, (char)(GLYPH_FIRST + i), SSD1306_WHITE,
+                     SSD1306_BLACK, 1);
+    memcpy(glyphCache[i], display.getBuffer(), 5);
+  }
+  glyphCacheValid = true;
+}
+
+// 把 text 按定宽单元格写进离屏缓冲的 page 页、第 charCol 个字符位。
+// 不足 cellWidth 补空格、超出截断：单元格永远覆盖同一块区域，
+// 旧内容自然被擦掉，布局不会被超宽的值冲垮
+static void blitCell(uint8_t page, uint8_t charCol, const char *text,
+                     uint8_t cellWidth) {
+  uint8_t *dst = display.getBuffer() + page * SCREEN_WIDTH + charCol * GLYPH_W;
+  for (uint8_t i = 0; i < cellWidth; i++) {
+    if ((charCol + i + 1) * GLYPH_W > SCREEN_WIDTH) {
+      break;
+    }
+    char c = *text ? *text++ : ' ';
+    if (c < GLYPH_FIRST || c > 0x7E) {
+      c = ' ';
+    }
+    memcpy(dst, glyphCache[c - GLYPH_FIRST], 5);
+    dst[5] = 0x00; // 间距列
+    dst += GLYPH_W;
+  }
+}
+
+// 固定布局的字符位（列 = 字符位 * 6px，页 = 行）。标签画一次，
+// 数字字段每帧只重写自己的单元格
+static void drawStaticLabels() {
+  memset(display.getBuffer(), 0, SCREEN_WIDTH * SCREEN_HEIGHT / 8);
+  blitCell(0, 0, "Spd:", 4);
+  blitCell(0, 12, "Crs:", 4);
+  blitCell(1, 0, "Date:", 5);
+  blitCell(2, 0, "Time:", 5);
+  blitCell(3, 0, "Lat:", 4);
+  blitCell(4, 0, "Lng:", 4);
+  blitCell(5, 0, "A:", 2);
+  blitCell(5, 10, "S:", 2);
+  blitCell(5, 15, "H:", 2);
+  blitCell(6, 0, "GPS:", 4);
+  blitCell(7, 7, "Bat:", 4);
+  staticLabelsDrawn = true;
+}
+
 // Track display state
 bool isDisplayOn = true;
 unsigned long lastActivityTime = 0; // Track time of last activity for auto-off
@@ -30,6 +172,7 @@ void turnDisplayOn() {
     }
     isDisplayOn = true;
     resetDisplayTimeout(); // Reset timer when display turns on
+    staticLabelsDrawn = false; // 关屏时缓冲被清空，标签层要重画
     Log.println("Display ON");
     updateDisplay(); // Update display immediately when turned on
     // It's generally safe to call start() on an already started or stopped
@@ -45,10 +188,10 @@ void turnDisplayOn() {
 void turnDisplayOff() {
   if (isDisplayOn) {
     {
-      I2C_LockGuard lock; // Ensure I2C access is thread-safe
+      I2C_LockGuard lock(I2C_PRIO_LOW);
 
       display.clearDisplay();
-      display.display(); // Show cleared screen before turning off
+      flushDirtyFrame(true); // 清屏整推，同时让 diff 基准与屏幕一致
       display.ssd1306_command(SSD1306_DISPLAYOFF);
     }
     isDisplayOn = false;
@@ -78,14 +221,10 @@ bool initDisplay() {
   isDisplayOn = true; // Start with display on
   lastActivityTime = millis();
   turnDisplayOn();   // Explicitly turn on (this will also reset the timer)
-  display.display(); // show splash screen (Adafruit logo)
+  flushDirtyFrame(true); // show splash screen (Adafruit logo)
   delay(500);        // Pause
+  buildGlyphCache(); // 用 GFX 字体栅格化字形表（会破坏缓冲内容）
   display.clearDisplay();
-  display.setTextSize(1);              // Default text size
-  display.setTextColor(SSD1306_WHITE); // Default text color
-  display.setCursor(0, 0);             // Default cursor position
-  // display.println("OLED Initialized"); // Don't show this, let first update
-  // handle it display.display(); delay(500);
   displayRefreshTimer.begin(DISPLAY_UPDATE_INTERVAL_MS,
                             refreshDisplayTimerCallback, NULL,
                             true); // Start the timer for display refresh
@@ -95,176 +234,125 @@ bool initDisplay() {
 
 // Function to update the display based on the global gSystemInfo
 void updateDisplay() {
-  I2C_LockGuard lock; // Ensure I2C access is thread-safe
-  if (!isDisplayOn)
+  // 低优先级拿锁：整帧推送是总线上最长的突发，传感器优先
+  I2C_LockGuard lock(I2C_PRIO_LOW);
+  if (!isDisplayOn || !glyphCacheValid)
     return; // Do nothing if display is off
 
-  // No need to reset timer here, only on explicit actions
+  // 本函数跑在 timer 任务，取一致快照再排版：直接读 gSystemInfo
+  // 可能撞上 loop 任务写了一半的 lat/lon 对
+  SystemInfo info;
+  systemInfoSnapshot(info);
 
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setTextColor(SSD1306_WHITE);
-  display.setCursor(0, 0);
-
-  char buffer[32]; // Buffer for formatting strings
-
-  // Line 1: Speed / Course
-  display.print("Spd:");
-  if (gSystemInfo.speed >= 0.0f) {
-    snprintf(buffer, sizeof(buffer), "%.1f", gSystemInfo.speed); // Use snprintf
-    display.print(buffer);
-    // display.print("km/h"); // Remove unit to save space if needed, or keep
-  } else {
-    display.print("N/A");
-  }
-  // 如果静止，显示 S 标记
-  if (gSystemInfo.isStationary) {
-    display.print(" S");
-  }
-  // Calculate position for Course
-  String courseLabel = " Crs:";
-  String courseValueStr;
-  if (gSystemInfo.course >= 0.0f) {
-    snprintf(buffer, sizeof(buffer), "%.0f",
-             gSystemInfo.course); // Use snprintf
-    courseValueStr = buffer;
-  } else {
-    courseValueStr = "N/A";
+  if (!staticLabelsDrawn) {
+    drawStaticLabels();
   }
 
-  int16_t x1, y1;
-  uint16_t w, h;
-  // Calculate width needed for label + value
-  display.getTextBounds(courseLabel + courseValueStr, 0, 0, &x1, &y1, &w, &h);
-  int courseX = SCREEN_WIDTH - w - 1; // Position cursor for right alignment
-  // Ensure it doesn't overlap speed too much
-  if (courseX < display.getCursorX() + 5) {
-    courseX = display.getCursorX() + 5;
-  }
-  int16_t currentY = display.getCursorY(); // Get Y before potential wrap
-  display.setCursor(courseX, currentY);
-  display.print(courseLabel);
-  display.println(courseValueStr); // Use println to move to next line
-
-  // Line 2: Date
-  display.print("Date: ");
-  if (gSystemInfo.dateTimeValid) {
-    snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", gSystemInfo.year,
-             gSystemInfo.month, gSystemInfo.day);
-    display.println(buffer);
+  char buffer[24]; // Buffer for formatting strings
+
+  // Line 1: Speed / Stationary / Course
+  if (info.speed >= 0.0f) {
+    snprintf(buffer, sizeof(buffer), "%5.1f", info.speed);
   } else {
-    display.println("N/A");
+    snprintf(buffer, sizeof(buffer), "  N/A");
   }
-
-  // Line 3: Time
-  display.print("Time: ");
-  if (gSystemInfo.dateTimeValid) {
-    snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", gSystemInfo.hour,
-             gSystemInfo.minute, gSystemInfo.second);
-    display.println(buffer);
+  blitCell(0, 4, buffer, 5);
+  blitCell(0, 10, info.isStationary ? "S" : " ", 1); // 静止标记
+  if (info.course >= 0.0f) {
+    snprintf(buffer, sizeof(buffer), "%3.0f", info.course);
   } else {
-    display.println("N/A");
+    snprintf(buffer, sizeof(buffer), "N/A");
   }
+  blitCell(0, 16, buffer, 3);
 
-  // Line 4: Lat
-  display.print("Lat:");
-  if (gSystemInfo.locationValid) {
-    snprintf(buffer, sizeof(buffer), "%.6f",
-             gSystemInfo.latitude); // Use snprintf
-    display.println(buffer);
+  // Line 2/3: Date / Time
+  if (info.dateTimeValid) {
+    snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", info.year, info.month,
+             info.day);
+    blitCell(1, 6, buffer, 10);
+    snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", info.hour, info.minute,
+             info.second);
+    blitCell(2, 6, buffer, 8);
   } else {
-    display.println("N/A");
+    blitCell(1, 6, "N/A", 10);
+    blitCell(2, 6, "N/A", 8);
   }
 
-  // Line 5: Lng
-  display.print("Lng:");
-  if (gSystemInfo.locationValid) {
-    snprintf(buffer, sizeof(buffer), "%.6f",
-             gSystemInfo.longitude); // Use snprintf
-    display.println(buffer);
+  // Line 4/5: Lat / Lng
+  if (info.locationValid) {
+    snprintf(buffer, sizeof(buffer), "%11.6f", info.latitude);
+    blitCell(3, 4, buffer, 11);
+    snprintf(buffer, sizeof(buffer), "%11.6f", info.longitude);
+    blitCell(4, 4, buffer, 11);
   } else {
-    display.println("N/A");
+    blitCell(3, 4, "N/A", 11);
+    blitCell(4, 4, "N/A", 11);
   }
 
   // Line 6: Alt / Sats / HDOP
-  display.print("A:");
-  if (gSystemInfo.locationValid) {
-    snprintf(buffer, sizeof(buffer), "%.1f",
-             gSystemInfo.altitude); // Use snprintf
-    display.print(buffer);
-    display.print("m");
+  if (info.locationValid) {
+    snprintf(buffer, sizeof(buffer), "%6.1fm", info.altitude);
   } else {
-    display.print("N/A");
+    snprintf(buffer, sizeof(buffer), "   N/A");
   }
-
-  display.print(" S:");
-  display.print(gSystemInfo.satellites);
-
-  display.print(" H:");
-  if (gSystemInfo.hdop < 99.0f) { // Check against the invalid value
-    snprintf(buffer, sizeof(buffer), "%.1f", gSystemInfo.hdop); // Use snprintf
-    display.println(buffer);
+  blitCell(5, 2, buffer, 7);
+  uint32_t sats = (info.satellites > 99) ? 99 : info.satellites;
+  snprintf(buffer, sizeof(buffer), "%2lu", (unsigned long)sats);
+  blitCell(5, 12, buffer, 2);
+  if (info.hdop < 99.0f) { // Check against the invalid value
+    snprintf(buffer, sizeof(buffer), "%4.1f", info.hdop);
   } else {
-    display.println("N/A");
+    snprintf(buffer, sizeof(buffer), " N/A");
   }
+  blitCell(5, 17, buffer, 4);
 
-  // Line 7: GPS Status (Left)
-  display.print("GPS: ");
-  switch (gSystemInfo.gpsState) {
+  // Line 7: GPS Status
+  const char *stateStr;
+  switch (info.gpsState) {
   case S0_INITIALIZING:
-    display.print("Initializing");
+    stateStr = "Initializing";
     break;
   case S1_GPS_SEARCHING_FIX:
-    display.print("Searching");
+    stateStr = "Searching";
     break;
   case S2_IDLE_GPS_OFF:
-    display.print("Idle (GPS Off)");
+    stateStr = "Idle (GPS Off)";
     break;
   case S3_TRACKING_FIXED:
-    display.print("Fixed");
+    stateStr = "Fixed";
     break;
   case S4_ANALYZING_STILLNESS:
-    display.print("Analyze-Still");
+    stateStr = "Analyze-Still";
     break;
   case S5_AGNSS_PROCESSING:
-    display.print("AGNSS Proc");
+    stateStr = "AGNSS Proc";
     break;
   default:
-    display.print("Unknown");
+    stateStr = "Unknown";
     break;
   }
+  blitCell(6, 5, stateStr, 14);
 
-  // Line 8: Battery (Placeholder) - Bottom right corner
-  String battLabel = "Bat:";
-  String battValueStr;
-  if (gSystemInfo.batteryVoltage >= 0.0f) {
-    snprintf(buffer, sizeof(buffer), "%.2f",
-             gSystemInfo.batteryVoltage); // Use snprintf
-    battValueStr = buffer;                // Assuming it's percentage or voltage
-    battValueStr += "V";                  // Add unit if needed
-    battValueStr += "/";
-    snprintf(buffer, sizeof(buffer), "%.0f",
-             estimateBatteryLevel(gSystemInfo.batteryVoltage *
-                                  1000)); // Use snprintf
-    battValueStr += buffer;               // Append battery level
-    battValueStr += "%";                  // Add percentage sign
+  // Line 8: Battery - bottom right
+  if (info.batteryVoltage >= 0.0f) {
+    snprintf(buffer, sizeof(buffer), "%.2fV/%3.0f%%", info.batteryVoltage,
+             estimateBatteryLevel(info.batteryVoltage * 1000));
   } else {
-    battValueStr = "N/A";
+    snprintf(buffer, sizeof(buffer), "N/A");
   }
+  blitCell(7, 11, buffer, 10);
 
-  // Get text bounds for battery info to calculate width
-  display.getTextBounds(battLabel + battValueStr, 0, 0, &x1, &y1, &w, &h);
-  // Set cursor to bottom right corner
-  display.setCursor(SCREEN_WIDTH - w - 1, SCREEN_HEIGHT - h);
-  display.print(battLabel);
-  display.print(battValueStr);
-
-  display.display();
+  // 只推送与上一帧不同的列区间（时钟跳秒等典型更新只有几十字节）
+  flushDirtyFrame();
 }
 
 // Function to check and handle display timeout (call this in main loop)
 bool checkDisplayTimeout() {
-  if (isDisplayOn && (millis() - lastActivityTime > DISPLAY_TIMEOUT_MS)) {
+  // 空闲档（S2/S4 静止）提前熄屏：档位恢复活动后按键照常点亮
+  unsigned long timeoutMs = (currentPowerTier() == POWER_TIER_IDLE)
+                                ? DISPLAY_TIMEOUT_IDLE_MS
+                                : DISPLAY_TIMEOUT_MS;
+  if (isDisplayOn && (millis() - lastActivityTime > timeoutMs)) {
     Log.println("Display timeout reached.");
     turnDisplayOff();
     return true; // Display was turned off due to timeout
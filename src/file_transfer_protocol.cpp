@@ -1,6 +1,16 @@
 #include "file_transfer_protocol.h"
+#include "agnss_ring.h"
+#include "battery_telemetry.h"
+#include "ble_handler.h"
+#include "flight_recorder.h"
+#include "gps_data_decoder.h"
+#include "mem_arena.h"
+#include "sd_handler.h"
+#include "track_simplifier.h"
+#include "crc32.h"
 #include "gps_handler.h"
 #include "logger.h"
+#include "perf_stats.h"
 #include "system_info.h"
 
 // SdFat instance from sd_simple.cpp
@@ -9,8 +19,20 @@ extern SdFat sd;
 FileTransferProtocol::FileTransferProtocol(Stream *stream)
     : _stream(stream), _fileOpened(false), _dirOpen(false),
       _listingInProgress(false), _cmdState(WAIT_CMD_ID), _bytesRead(0),
-      _agnssWriteInProgress(false) {
+      _agnssWriteInProgress(false), _rangeActive(false), _rangeOffset(0),
+      _rangeEnd(0), _rangeChunkSize(0), _rangeSeq(0), _rangeCredits(0),
+      _rangeWithCrc(false), _transferId(0), _missingCount(0),
+      _missingIndex(0), _bulkActive(false), _bulkOffset(0), _bulkEnd(0),
+      _bulkCrc(0), _sysinfoNotifyEnabled(false),
+      _sysinfoMinIntervalMs(1000), _sysinfoLastNotifyMs(0),
+      _sysinfoForceFull(false), _dirSnapshot(nullptr), _dirSnapshotCount(0),
+      _dirSnapshotValid(false), _previewValid(false), _previewEpsilonM(0),
+      _previewCount(0) {
   memset(_currentPath, 0, MAX_PATH_LENGTH);
+  memset(_openFilePath, 0, MAX_PATH_LENGTH);
+  memset(_dirSnapshotPath, 0, MAX_PATH_LENGTH);
+  memset(_previewPath, 0, MAX_PATH_LENGTH);
+  memset(&_sysinfoLastSent, 0, sizeof(_sysinfoLastSent));
 }
 
 void FileTransferProtocol::start() {
@@ -100,9 +122,27 @@ void FileTransferProtocol::sendResponse(uint8_t *payload, uint16_t length) {
   if (length > 0 && payload != nullptr) {
     memcpy(&_buffer[2], payload, length);
   }
-  // 发送 buffer
-  _stream->write(_buffer, length + 2); // 2 bytes for length
-  _stream->flush();                    // 确保数据已发送
+  // 发送 buffer（进 TX 环；环满返回 0，整包丢弃并记日志——
+  // 区间传输类调用方在发送前已用 availableForWrite 探询过）
+  size_t queued = _stream->write(_buffer, length + 2); // 2 bytes for length
+  if (queued == 0) {
+    Log.printf("响应入队失败（TX 环满），丢弃 %d 字节\n", (int)(length + 2));
+    return;
+  }
+  _stream->flush(); // 尽力发一轮，不阻塞
+}
+
+// 周期服务：续推因 TX 环背压暂停的推流（额度还在，只是环当时满了）
+void FileTransferProtocol::serviceTransfers() {
+  if (_rangeActive) {
+    serviceRangeTransfer();
+  }
+  if (_missingIndex < _missingCount) {
+    serviceMissingRanges();
+  }
+  if (_bulkActive) {
+    serviceBulkOffload();
+  }
 }
 
 void FileTransferProtocol::process() {
@@ -159,6 +199,54 @@ void FileTransferProtocol::process() {
       processGpsWakeup();
       break;
 
+    case CMD_READ_RANGE:
+      processReadRange();
+      break;
+
+    case CMD_RANGE_CREDIT:
+      processRangeCredit();
+      break;
+
+    case CMD_GET_TRANSFER_STATE:
+      processGetTransferState();
+      break;
+
+    case CMD_READ_MISSING:
+      processReadMissing();
+      break;
+
+    case CMD_SYSINFO_SUBSCRIBE:
+      processSysInfoSubscribe();
+      break;
+
+    case CMD_GET_PERF_STATS:
+      processGetPerfStats();
+      break;
+
+    case CMD_GET_BATTERY_LOG:
+      processGetBatteryLog();
+      break;
+
+    case CMD_GET_CRASH_LOG:
+      processGetCrashLog();
+      break;
+
+    case CMD_READ_TIME_RANGE:
+      processReadTimeRange();
+      break;
+
+    case CMD_GET_TRACK_PREVIEW:
+      processGetTrackPreview();
+      break;
+
+    case CMD_BULK_OFFLOAD:
+      processBulkOffload();
+      break;
+
+    case CMD_RECENT_TRACK:
+      processRecentTrack();
+      break;
+
     default:
       Log.printf("未知命令ID: 0x%02X\n", _cmdId);
       // 发送空响应表示错误
@@ -175,6 +263,27 @@ void FileTransferProtocol::processListDir() {
   uint8_t responseBuffer[128];
   uint16_t responseLength = 0;
 
+  // 扩展载荷 [pathLen:1][path][offset:2 LE][count:1] 走分页模式：
+  // 一个响应带一批条目，目录快照缓存避免每页重走 FAT。
+  // 旧客户端载荷只有路径，保持逐条目的兼容行为
+  {
+    uint8_t pathLength = _buffer[0];
+    if (!_listingInProgress && _payloadLength >= (uint16_t)(1 + pathLength + 3)) {
+      char path[MAX_PATH_LENGTH];
+      memset(path, 0, sizeof(path));
+      if (pathLength > 0) {
+        memcpy(path, &_buffer[1], min(pathLength, MAX_PATH_LENGTH - 1));
+      } else {
+        strcpy(path, "/");
+      }
+      uint16_t offset =
+          _buffer[1 + pathLength] | (_buffer[1 + pathLength + 1] << 8);
+      uint8_t count = _buffer[1 + pathLength + 2];
+      processListDirPaged(path, offset, count);
+      return;
+    }
+  }
+
   // 首次列目录或继续上次列目录
   if (!_listingInProgress) {
     // 这是新的LIST_DIR命令
@@ -249,6 +358,105 @@ void FileTransferProtocol::processListDir() {
   sendResponse(responseBuffer, responseLength);
 }
 
+void FileTransferProtocol::invalidateDirSnapshot() {
+  _dirSnapshotValid = false;
+  _dirSnapshotCount = 0;
+}
+
+// 整目录走一遍，记录每个条目的目录项索引。之后的页请求用
+// open-by-index 直达条目，不再从头 openNext
+bool FileTransferProtocol::rebuildDirSnapshot(const char *path) {
+  invalidateDirSnapshot();
+  // 索引数组在会话内首次分页时从 BLE 会话 arena 拿，之后复用；
+  // 断线随区域复位归还（releaseSessionBuffers）
+  if (_dirSnapshot == nullptr) {
+    _dirSnapshot =
+        (uint16_t *)bleSessionArena().alloc(DIR_SNAPSHOT_MAX * sizeof(uint16_t));
+    if (_dirSnapshot == nullptr) {
+      Log.println("目录快照: 会话 arena 耗尽");
+      return false;
+    }
+  }
+  if (_dirOpen) {
+    _currentDirectory.close();
+    _dirOpen = false;
+  }
+  if (!_currentDirectory.open(path, O_READ)) {
+    return false;
+  }
+  _dirOpen = true;
+  _listingInProgress = false; // 快照模式接管，丢弃逐条会话
+
+  SdFile entry;
+  while (_dirSnapshotCount < DIR_SNAPSHOT_MAX &&
+         entry.openNext(&_currentDirectory, O_READ)) {
+    _dirSnapshot[_dirSnapshotCount++] = entry.dirIndex();
+    entry.close();
+  }
+  strncpy(_dirSnapshotPath, path, MAX_PATH_LENGTH - 1);
+  _dirSnapshotPath[MAX_PATH_LENGTH - 1] = '\0';
+  _dirSnapshotValid = true;
+  Log.printf("目录快照: %s, %u 条目\n", path, _dirSnapshotCount);
+  return true;
+}
+
+// 分页响应: [total:2][offset:2][n:1] 然后 n 个条目
+//   [type:1][nameLen:1][name][size:4 仅文件]
+// n 受 count 和响应缓冲区双重限制，客户端按 offset += n 翻页
+void FileTransferProtocol::processListDirPaged(const char *path,
+                                               uint16_t offset, uint8_t count) {
+  // 路径变了或快照失效（删除过文件）才重走 FAT
+  if (!_dirSnapshotValid || strcmp(path, _dirSnapshotPath) != 0 || !_dirOpen) {
+    if (!rebuildDirSnapshot(path)) {
+      Log.printf("无法打开目录: %s\n", path);
+      sendResponse(nullptr, 0);
+      return;
+    }
+  }
+
+  uint8_t responseBuffer[520];
+  uint16_t responseLength = 0;
+  memcpy(&responseBuffer[responseLength], &_dirSnapshotCount, 2);
+  responseLength += 2;
+  memcpy(&responseBuffer[responseLength], &offset, 2);
+  responseLength += 2;
+  uint16_t countPos = responseLength++; // n 回填
+
+  uint8_t n = 0;
+  if (count == 0) {
+    count = 255;
+  }
+  for (uint16_t i = offset; i < _dirSnapshotCount && n < count; i++) {
+    SdFile entry;
+    if (!entry.open(&_currentDirectory, _dirSnapshot[i], O_READ)) {
+      break; // 目录被并发修改，客户端拿 total 对不上会重新拉
+    }
+    char name[MAX_PATH_LENGTH];
+    entry.getName(name, sizeof(name));
+    uint8_t nameLength = strlen(name);
+    bool isDir = entry.isDir();
+    uint16_t entryLen = 2 + nameLength + (isDir ? 0 : 4);
+    if (responseLength + entryLen > sizeof(responseBuffer)) {
+      entry.close();
+      break; // 本页装满，剩下的下一页
+    }
+    responseBuffer[responseLength++] =
+        isDir ? ENTRY_TYPE_DIRECTORY : ENTRY_TYPE_FILE;
+    responseBuffer[responseLength++] = nameLength;
+    memcpy(&responseBuffer[responseLength], name, nameLength);
+    responseLength += nameLength;
+    if (!isDir) {
+      uint32_t size = entry.fileSize();
+      memcpy(&responseBuffer[responseLength], &size, 4);
+      responseLength += 4;
+    }
+    entry.close();
+    n++;
+  }
+  responseBuffer[countPos] = n;
+  sendResponse(responseBuffer, responseLength);
+}
+
 void FileTransferProtocol::processOpenFile() {
   uint8_t responseBuffer[4]; // 仅用于文件大小
   uint16_t responseLength = 0;
@@ -257,6 +465,7 @@ void FileTransferProtocol::processOpenFile() {
   if (_fileOpened) {
     _currentOpenFile.close();
     _fileOpened = false;
+    _rangeActive = false; // 旧文件上的区间传输随之作废
   }
 
   // 解析路径
@@ -282,6 +491,17 @@ void FileTransferProtocol::processOpenFile() {
 
   _fileOpened = true;
 
+  // 传输要开始了：把连接间隔切到快档
+  BleHandler::requestFastConnParams();
+
+  // 建立新的传输会话：记录路径并递增会话 ID，
+  // 断线重连后客户端可通过 GET_TRANSFER_STATE 恢复
+  strncpy(_openFilePath, filePath, MAX_PATH_LENGTH - 1);
+  _openFilePath[MAX_PATH_LENGTH - 1] = '\0';
+  _transferId++;
+  _missingCount = 0;
+  _missingIndex = 0;
+
   // 获取文件大小
   uint32_t fileSize = _currentOpenFile.fileSize();
   memcpy(responseBuffer, &fileSize, 4); // 小端序
@@ -340,11 +560,270 @@ void FileTransferProtocol::processReadChunk() {
   sendResponse(responseBuffer, actualBytesRead + dataOffset);
 }
 
+// READ_RANGE：一条命令启动一段区间的流式下载。
+// 载荷: [offset:4] [length:4] [chunkSize:2] [credits:1]
+// 之后设备在额度内主动推送数据块（每块载荷 [seq:2] [data]），
+// 客户端通过 CMD_RANGE_CREDIT 补充额度实现流控。
+// 相比逐块 READ_CHUNK，省掉了每块一来一回的连接间隔等待。
+void FileTransferProtocol::processReadRange() {
+  if (!_fileOpened) {
+    Log.println("READ_RANGE: 没有打开的文件");
+    sendResponse(nullptr, 0);
+    return;
+  }
+  if (_payloadLength < 11) {
+    Log.println("READ_RANGE: 载荷长度无效");
+    sendResponse(nullptr, 0);
+    return;
+  }
+
+  uint32_t offset, length;
+  uint16_t chunkSize;
+  memcpy(&offset, &_buffer[0], 4);
+  memcpy(&length, &_buffer[4], 4);
+  memcpy(&chunkSize, &_buffer[8], 2);
+  uint8_t credits = _buffer[10];
+  // 可选 Flags 字节（载荷 ≥12）：bit0 = 每块附带 CRC32 尾部
+  uint8_t flags = (_payloadLength >= 12) ? _buffer[11] : 0;
+
+  // 数据块大小受响应缓冲区限制（2 字节序号 + 数据）
+  if (chunkSize == 0 || chunkSize > 512) {
+    chunkSize = 512;
+  }
+
+  uint32_t fileSize = _currentOpenFile.fileSize();
+  if (offset >= fileSize) {
+    Log.printf("READ_RANGE: offset %lu 超出文件大小 %lu\n", offset, fileSize);
+    sendResponse(nullptr, 0);
+    return;
+  }
+  if (length > fileSize - offset) {
+    length = fileSize - offset;
+  }
+
+  _rangeActive = true;
+  _rangeOffset = offset;
+  _rangeEnd = offset + length;
+  _rangeChunkSize = chunkSize;
+  _rangeSeq = 0;
+  _rangeCredits = credits;
+  _rangeWithCrc = (flags & 0x01) != 0;
+
+  Log.printf("READ_RANGE: offset=%lu len=%lu chunk=%u credits=%u\n", offset,
+             length, chunkSize, credits);
+
+  serviceRangeTransfer();
+}
+
+// CMD_RANGE_CREDIT：载荷 [credits:1]，为进行中的传输补充发送额度
+void FileTransferProtocol::processRangeCredit() {
+  if (_payloadLength < 1 || (!_rangeActive && _missingIndex >= _missingCount)) {
+    return; // 没有进行中的传输时静默忽略，额度消息不需要应答
+  }
+  uint16_t newCredits = (uint16_t)_rangeCredits + _buffer[0];
+  _rangeCredits = (newCredits > 255) ? 255 : (uint8_t)newCredits;
+  serviceRangeTransfer();
+  serviceMissingRanges();
+}
+
+// 在剩余额度内连续推送数据块。顺序读让 SdFat 的预读和 BLE 发送
+// FIFO 的排空自然重叠，接近链路实际吞吐。
+void FileTransferProtocol::serviceRangeTransfer() {
+  uint8_t chunkBuffer[2 + 512 + 4]; // [seq:2] + 数据 + 可选[crc32:4]
+
+  while (_rangeActive && _rangeCredits > 0 && _rangeOffset < _rangeEnd) {
+    // TX 环放不下下一块就停：不忙等，周期服务会再回来推
+    if (_stream->availableForWrite() <
+        (int)(2 + _rangeChunkSize + (_rangeWithCrc ? 4 : 0) + 2)) {
+      break;
+    }
+    uint32_t remaining = _rangeEnd - _rangeOffset;
+    uint16_t toRead = _rangeChunkSize;
+    if (remaining < toRead) {
+      toRead = (uint16_t)remaining;
+    }
+
+    if (!_currentOpenFile.seekSet(_rangeOffset)) {
+      Log.println("READ_RANGE: seek失败，中止传输");
+      _rangeActive = false;
+      sendResponse(nullptr, 0);
+      return;
+    }
+    int bytesRead = _currentOpenFile.read(&chunkBuffer[2], toRead);
+    if (bytesRead <= 0) {
+      Log.println("READ_RANGE: 读取失败，中止传输");
+      _rangeActive = false;
+      sendResponse(nullptr, 0);
+      return;
+    }
+
+    chunkBuffer[0] = _rangeSeq & 0xFF;
+    chunkBuffer[1] = (_rangeSeq >> 8) & 0xFF;
+    uint16_t chunkLength = (uint16_t)(bytesRead + 2);
+    if (_rangeWithCrc) {
+      uint32_t crc = crc32_calc(&chunkBuffer[2], bytesRead);
+      memcpy(&chunkBuffer[chunkLength], &crc, 4); // 小端序
+      chunkLength += 4;
+    }
+    sendResponse(chunkBuffer, chunkLength);
+
+    _rangeOffset += bytesRead;
+    _rangeSeq++;
+    _rangeCredits--;
+  }
+
+  if (_rangeActive && _rangeOffset >= _rangeEnd) {
+    _rangeActive = false;
+    Log.printf("READ_RANGE: 传输完成，共 %u 块\n", _rangeSeq);
+  }
+}
+
+// GET_TRANSFER_STATE：断线重连后查询传输会话。
+// 响应: [transferId:2] [fileOpen:1] [fileSize:4] [pathLen:1] [path]
+// 客户端比对 transferId 与路径后，用 READ_MISSING/READ_RANGE 续传，
+// 不必从零字节重新下载。
+void FileTransferProtocol::processGetTransferState() {
+  uint8_t responseBuffer[8 + MAX_PATH_LENGTH];
+  uint16_t offset = 0;
+
+  responseBuffer[offset++] = _transferId & 0xFF;
+  responseBuffer[offset++] = (_transferId >> 8) & 0xFF;
+  responseBuffer[offset++] = _fileOpened ? 1 : 0;
+
+  uint32_t fileSize = _fileOpened ? _currentOpenFile.fileSize() : 0;
+  memcpy(&responseBuffer[offset], &fileSize, 4);
+  offset += 4;
+
+  uint8_t pathLength = _fileOpened ? (uint8_t)strlen(_openFilePath) : 0;
+  responseBuffer[offset++] = pathLength;
+  if (pathLength > 0) {
+    memcpy(&responseBuffer[offset], _openFilePath, pathLength);
+    offset += pathLength;
+  }
+
+  sendResponse(responseBuffer, offset);
+}
+
+// READ_MISSING：稀疏重传。客户端根据收到的块位图算出缺失区间，
+// 一次最多报 MAX_MISSING_RANGES 个。
+// 载荷: [transferId:2] [chunkSize:2] [credits:1] [count:1]
+//       count × ([offset:4] [length:4])
+// 补发块载荷: [offset:4] [data] [crc32:4]，offset 自描述便于稀疏回填。
+void FileTransferProtocol::processReadMissing() {
+  if (!_fileOpened) {
+    Log.println("READ_MISSING: 没有打开的文件");
+    sendResponse(nullptr, 0);
+    return;
+  }
+  if (_payloadLength < 6) {
+    Log.println("READ_MISSING: 载荷长度无效");
+    sendResponse(nullptr, 0);
+    return;
+  }
+
+  uint16_t transferId;
+  memcpy(&transferId, &_buffer[0], 2);
+  if (transferId != _transferId) {
+    Log.printf("READ_MISSING: 会话 ID 不匹配 (%u != %u)\n", transferId,
+               _transferId);
+    sendResponse(nullptr, 0);
+    return;
+  }
+
+  uint16_t chunkSize;
+  memcpy(&chunkSize, &_buffer[2], 2);
+  if (chunkSize == 0 || chunkSize > 512) {
+    chunkSize = 512;
+  }
+  uint8_t credits = _buffer[4];
+  uint8_t count = _buffer[5];
+  if (count > MAX_MISSING_RANGES) {
+    count = MAX_MISSING_RANGES;
+  }
+  if (_payloadLength < (uint16_t)(6 + count * 8)) {
+    Log.println("READ_MISSING: 区间列表不完整");
+    sendResponse(nullptr, 0);
+    return;
+  }
+
+  for (uint8_t i = 0; i < count; i++) {
+    memcpy(&_missingRanges[i].offset, &_buffer[6 + i * 8], 4);
+    memcpy(&_missingRanges[i].length, &_buffer[6 + i * 8 + 4], 4);
+  }
+  _missingCount = count;
+  _missingIndex = 0;
+  _rangeChunkSize = chunkSize;
+  _rangeCredits = credits;
+  _rangeActive = false; // 重传接管额度，顺序流暂停
+
+  Log.printf("READ_MISSING: %u 个缺失区间, chunk=%u credits=%u\n", count,
+             chunkSize, credits);
+
+  serviceMissingRanges();
+}
+
+// 在额度内补发缺失区间，块内带文件偏移与 CRC32
+void FileTransferProtocol::serviceMissingRanges() {
+  uint8_t chunkBuffer[4 + 512 + 4]; // [offset:4] + 数据 + [crc32:4]
+
+  while (_missingIndex < _missingCount && _rangeCredits > 0) {
+    // 与 serviceRangeTransfer 相同的背压检查
+    if (_stream->availableForWrite() <
+        (int)(4 + _rangeChunkSize + 4 + 2)) {
+      break;
+    }
+    MissingRange &range = _missingRanges[_missingIndex];
+    if (range.length == 0) {
+      _missingIndex++;
+      continue;
+    }
+
+    uint16_t toRead = _rangeChunkSize;
+    if (range.length < toRead) {
+      toRead = (uint16_t)range.length;
+    }
+
+    if (!_currentOpenFile.seekSet(range.offset)) {
+      Log.println("READ_MISSING: seek失败，中止重传");
+      _missingCount = 0;
+      _missingIndex = 0;
+      sendResponse(nullptr, 0);
+      return;
+    }
+    int bytesRead = _currentOpenFile.read(&chunkBuffer[4], toRead);
+    if (bytesRead <= 0) {
+      Log.println("READ_MISSING: 读取失败，中止重传");
+      _missingCount = 0;
+      _missingIndex = 0;
+      sendResponse(nullptr, 0);
+      return;
+    }
+
+    memcpy(&chunkBuffer[0], &range.offset, 4);
+    uint32_t crc = crc32_calc(&chunkBuffer[4], bytesRead);
+    memcpy(&chunkBuffer[4 + bytesRead], &crc, 4);
+    sendResponse(chunkBuffer, (uint16_t)(bytesRead + 8));
+
+    range.offset += bytesRead;
+    range.length -= bytesRead;
+    _rangeCredits--;
+  }
+
+  if (_missingIndex >= _missingCount && _missingCount > 0) {
+    Log.println("READ_MISSING: 重传完成");
+    _missingCount = 0;
+    _missingIndex = 0;
+  }
+}
+
 void FileTransferProtocol::processCloseFile() {
+  _rangeActive = false; // 关闭文件同时中止进行中的区间传输
   if (_fileOpened) {
     _currentOpenFile.close();
     _fileOpened = false;
     Log.println("文件已关闭");
+    // 传输结束，连接间隔回慢档省电
+    BleHandler::requestSlowConnParams();
   } else {
     Log.println("尝试关闭未打开的文件");
   }
@@ -395,6 +874,7 @@ void FileTransferProtocol::processDeleteFile() {
   bool ok = sd.remove(filePath);
   if (ok) {
     Log.println("文件删除成功");
+    invalidateDirSnapshot(); // 目录内容变了，下次分页重建快照
   } else {
     Log.println("文件删除失败");
   }
@@ -404,57 +884,749 @@ void FileTransferProtocol::processDeleteFile() {
 void FileTransferProtocol::processGetSysInfo() {
   uint8_t responseBuffer[64]; // 足够容纳所有字段
   uint16_t offset = 0;
+  // 取一致快照再打包：直接读 gSystemInfo 可能撞上写了一半的字段
+  SystemInfo info;
+  systemInfoSnapshot(info);
   // 按协议顺序打包 SystemInfo
   // double latitude
-  memcpy(&responseBuffer[offset], &gSystemInfo.latitude, 8);
+  memcpy(&responseBuffer[offset], &info.latitude, 8);
   offset += 8;
   // double longitude
-  memcpy(&responseBuffer[offset], &gSystemInfo.longitude, 8);
+  memcpy(&responseBuffer[offset], &info.longitude, 8);
   offset += 8;
   // float altitude
-  memcpy(&responseBuffer[offset], &gSystemInfo.altitude, 4);
+  memcpy(&responseBuffer[offset], &info.altitude, 4);
   offset += 4;
   // uint32_t satellites
-  memcpy(&responseBuffer[offset], &gSystemInfo.satellites, 4);
+  memcpy(&responseBuffer[offset], &info.satellites, 4);
   offset += 4;
   // float hdop
-  memcpy(&responseBuffer[offset], &gSystemInfo.hdop, 4);
+  memcpy(&responseBuffer[offset], &info.hdop, 4);
   offset += 4;
   // float speed
-  memcpy(&responseBuffer[offset], &gSystemInfo.speed, 4);
+  memcpy(&responseBuffer[offset], &info.speed, 4);
   offset += 4;
   // float course
-  memcpy(&responseBuffer[offset], &gSystemInfo.course, 4);
+  memcpy(&responseBuffer[offset], &info.course, 4);
   offset += 4;
   // uint16_t year
-  memcpy(&responseBuffer[offset], &gSystemInfo.year, 2);
+  memcpy(&responseBuffer[offset], &info.year, 2);
   offset += 2;
   // uint8_t month
-  responseBuffer[offset++] = gSystemInfo.month;
+  responseBuffer[offset++] = info.month;
   // uint8_t day
-  responseBuffer[offset++] = gSystemInfo.day;
+  responseBuffer[offset++] = info.day;
   // uint8_t hour
-  responseBuffer[offset++] = gSystemInfo.hour;
+  responseBuffer[offset++] = info.hour;
   // uint8_t minute
-  responseBuffer[offset++] = gSystemInfo.minute;
+  responseBuffer[offset++] = info.minute;
   // uint8_t second
-  responseBuffer[offset++] = gSystemInfo.second;
+  responseBuffer[offset++] = info.second;
   // uint8_t locationValid
-  responseBuffer[offset++] = gSystemInfo.locationValid ? 1 : 0;
+  responseBuffer[offset++] = info.locationValid ? 1 : 0;
   // uint8_t dateTimeValid
-  responseBuffer[offset++] = gSystemInfo.dateTimeValid ? 1 : 0;
+  responseBuffer[offset++] = info.dateTimeValid ? 1 : 0;
   // float batteryVoltage
-  memcpy(&responseBuffer[offset], &gSystemInfo.batteryVoltage, 4);
+  memcpy(&responseBuffer[offset], &info.batteryVoltage, 4);
   offset += 4;
   // uint8_t gpsState
-  responseBuffer[offset++] = (uint8_t)gSystemInfo.gpsState;
+  responseBuffer[offset++] = (uint8_t)info.gpsState;
+
+  sendResponse(responseBuffer, offset);
+}
+
+// 把当前系统信息（经 systemInfoSnapshot 取的一致快照）量化成通知
+// 用的快照。量化本身就定义了阈值的最小粒度（hdop 0.01、速度
+// 0.1 km/h、电压 1 mV）
+void FileTransferProtocol::quantizeSysInfo(SysInfoSnapshot &snap) const {
+  SystemInfo info;
+  systemInfoSnapshot(info);
+  snap.lat_1e7 = info.latitude_scaled_1e7;
+  snap.lon_1e7 = info.longitude_scaled_1e7;
+  snap.alt_cm = info.altitude_cm;
+  snap.satellites = (uint8_t)min(info.satellites, (uint32_t)255);
+  float hdop = info.hdop;
+  if (hdop < 0.0f)
+    hdop = 0.0f;
+  if (hdop > 99.99f)
+    hdop = 99.99f;
+  snap.hdop_scaled_1e2 = (uint16_t)(hdop * 100.0f + 0.5f);
+  float speed = info.speed;
+  if (speed < 0.0f)
+    speed = 0.0f;
+  snap.speed_scaled_1e1 = (uint16_t)(speed * 10.0f + 0.5f);
+  snap.gpsState = (uint8_t)info.gpsState;
+  float batt = info.batteryVoltage;
+  snap.battery_mv = (batt > 0.0f) ? (uint16_t)(batt * 1000.0f + 0.5f) : 0;
+  snap.flags = (info.locationValid ? 0x01 : 0) |
+               (info.dateTimeValid ? 0x02 : 0) |
+               (info.isStationary ? 0x04 : 0);
+}
+
+// CMD_SYSINFO_SUBSCRIBE：载荷 [enable:1] [min_interval_ms:2 LE 可选]。
+// 订阅后设备主动推送变化通知，不再需要客户端轮询 GET_SYS_INFO
+void FileTransferProtocol::processSysInfoSubscribe() {
+  if (_payloadLength < 1) {
+    sendResponse(nullptr, 0);
+    return;
+  }
+  bool enable = _buffer[0] != 0;
+  if (enable) {
+    uint16_t interval = 1000;
+    if (_payloadLength >= 3) {
+      memcpy(&interval, &_buffer[1], 2); // 小端序
+    }
+    if (interval < 200) {
+      interval = 200; // 避免把 BLE 链路刷满
+    }
+    _sysinfoMinIntervalMs = interval;
+    _sysinfoNotifyEnabled = true;
+    _sysinfoForceFull = true; // 首帧推全量，给客户端建立基线
+    _sysinfoLastNotifyMs = millis() - interval;
+    Log.printf("SYSINFO 订阅开启, 间隔 %u ms\n", interval);
+  } else {
+    _sysinfoNotifyEnabled = false;
+    Log.println("SYSINFO 订阅关闭");
+  }
+
+  uint8_t status = 0x01;
+  sendResponse(&status, 1);
+}
+
+// CMD_GET_PERF_STATS：载荷 [reset:1 可选]，非 0 表示读取后清零。
+// 响应: [slotCount:1] 然后每槽位
+//   [name:8 定长补零][count:4][max_us:4][buckets:12 × 4]
+// 桶刻度见 perf_stats.h（对数微秒桶）
+void FileTransferProtocol::processGetPerfStats() {
+  // 先锁存请求标志：sendResponse 复用 _buffer 组响应帧，发送后
+  // _buffer[0] 已是响应长度低字节而不是客户端的 reset 标志
+  bool resetRequested = _payloadLength >= 1 && _buffer[0] != 0;
+
+  uint8_t responseBuffer[1 + PERF_MAX_SLOTS *
+                                 (PERF_SLOT_NAME_LEN + 8 +
+                                  PERF_BUCKET_COUNT * 4)];
+  uint16_t offset = 0;
+
+  uint8_t count = perfSlotCount();
+  responseBuffer[offset++] = count;
+
+  for (uint8_t i = 0; i < count; i++) {
+    const PerfSlotStats *stats = perfSlotStats(i);
+    const char *name = perfSlotName(i);
+
+    memset(&responseBuffer[offset], 0, PERF_SLOT_NAME_LEN);
+    strncpy((char *)&responseBuffer[offset], name, PERF_SLOT_NAME_LEN);
+    offset += PERF_SLOT_NAME_LEN;
+
+    memcpy(&responseBuffer[offset], &stats->count, 4);
+    offset += 4;
+    memcpy(&responseBuffer[offset], &stats->max_us, 4);
+    offset += 4;
+    memcpy(&responseBuffer[offset], stats->buckets, PERF_BUCKET_COUNT * 4);
+    offset += PERF_BUCKET_COUNT * 4;
+  }
 
   sendResponse(responseBuffer, offset);
+
+  if (resetRequested) {
+    perfResetAll(); // 清零开新观察窗口
+  }
+}
+
+// CMD_GET_BATTERY_LOG：载荷 [start:2 LE][count:1]，都可省略
+// （省略 start 从最旧开始，省略 count 取本页上限）。
+// 响应: [total:2][start:2][n:1] 然后 n 条样本：
+//   [uptime_s:4][voltage_mv:2][gpsState:1][soc_pct:1]
+// total 是环内样本总数，客户端按 start 分页拉全量
+void FileTransferProtocol::processGetBatteryLog() {
+  // 每页条数上限：响应要装进一个协议帧
+  const uint8_t maxPerPage = 64;
+
+  uint16_t start = 0;
+  uint8_t requested = maxPerPage;
+  if (_payloadLength >= 2) {
+    start = _buffer[0] | (_buffer[1] << 8);
+  }
+  if (_payloadLength >= 3 && _buffer[2] != 0) {
+    requested = _buffer[2];
+  }
+  if (requested > maxPerPage) {
+    requested = maxPerPage;
+  }
+
+  uint16_t total = batteryTelemetryCount();
+  uint8_t responseBuffer[5 + maxPerPage * sizeof(BatteryTelemetrySample)];
+  uint16_t offset = 0;
+  memcpy(&responseBuffer[offset], &total, 2);
+  offset += 2;
+  memcpy(&responseBuffer[offset], &start, 2);
+  offset += 2;
+  uint8_t countPos = offset++; // n 回填
+
+  uint8_t n = 0;
+  BatteryTelemetrySample sample;
+  while (n < requested && batteryTelemetryGet(start + n, &sample)) {
+    memcpy(&responseBuffer[offset], &sample, sizeof(sample));
+    offset += sizeof(sample);
+    n++;
+  }
+  responseBuffer[countPos] = n;
+
+  sendResponse(responseBuffer, offset);
+}
+
+// CMD_GET_CRASH_LOG：载荷 [clear:1 可选]，非 0 表示读取后删除记录。
+// 响应: [present:1] + present=1 时附 FlightFaultRecord 原始字节
+// （布局见 flight_recorder.h，日志快照由主机侧离线格式化）
+void FileTransferProtocol::processGetCrashLog() {
+  // 先锁存 clear 标志：sendResponse 复用 _buffer 组响应帧，发送后
+  // _buffer[0] 已被响应长度低字节覆盖，单纯读取也会误删一次性记录
+  bool clearRequested = _payloadLength >= 1 && _buffer[0] != 0;
+
+  uint8_t responseBuffer[1 + sizeof(FlightFaultRecord)];
+  size_t n = flightRecorderReadCrash(&responseBuffer[1],
+                                     sizeof(responseBuffer) - 1);
+  responseBuffer[0] = (n > 0) ? 0x01 : 0x00;
+  sendResponse(responseBuffer, (uint16_t)(1 + n));
+
+  if (n > 0 && clearRequested) {
+    flightRecorderClearCrash();
+  }
+}
+
+// CMD_READ_TIME_RANGE：载荷 [pathLen:1][path][startTs:4][endTs:4]。
+// 用稀疏时间索引把时间段解析成以全量块对齐的字节范围。
+// 响应: [fileSize:4][offset:4][length:4]；文件不存在时发空响应。
+// 客户端随后 OPEN_FILE + READ_RANGE 只拉这个字节范围
+void FileTransferProtocol::processReadTimeRange() {
+  if (_payloadLength < 9) {
+    Log.println("READ_TIME_RANGE: 载荷长度无效");
+    sendResponse(nullptr, 0);
+    return;
+  }
+  uint8_t pathLength = _buffer[0];
+  if (pathLength == 0 || pathLength >= MAX_PATH_LENGTH ||
+      _payloadLength < (uint16_t)(1 + pathLength + 8)) {
+    Log.println("READ_TIME_RANGE: 路径长度无效");
+    sendResponse(nullptr, 0);
+    return;
+  }
+
+  char path[MAX_PATH_LENGTH];
+  memset(path, 0, MAX_PATH_LENGTH);
+  memcpy(path, &_buffer[1], pathLength);
+  uint32_t startTs, endTs;
+  memcpy(&startTs, &_buffer[1 + pathLength], 4);
+  memcpy(&endTs, &_buffer[1 + pathLength + 4], 4);
+
+  uint32_t offset = 0, length = 0, fileSize = 0;
+  if (!queryGpzTimeRange(path, startTs, endTs, &offset, &length, &fileSize)) {
+    Log.printf("READ_TIME_RANGE: 文件不存在: %s\n", path);
+    sendResponse(nullptr, 0);
+    return;
+  }
+
+  Log.printf("READ_TIME_RANGE: %s [%lu,%lu] -> offset=%lu len=%lu\n", path,
+             (unsigned long)startTs, (unsigned long)endTs,
+             (unsigned long)offset, (unsigned long)length);
+
+  uint8_t responseBuffer[12];
+  memcpy(&responseBuffer[0], &fileSize, 4);
+  memcpy(&responseBuffer[4], &offset, 4);
+  memcpy(&responseBuffer[8], &length, 4);
+  sendResponse(responseBuffer, 12);
+}
+
+// --- GET_TRACK_PREVIEW ---
+// 预览点缓存：整文件解码 + 抽稀的结果，分页导出时不重算。
+// 256 点 × 12B = 3 KB，够一屏地图概览
+#pragma pack(push, 1)
+struct PreviewPoint {
+  uint32_t timestamp;
+  int32_t lat_1e7;
+  int32_t lon_1e7;
+};
+#pragma pack(pop)
+#define PREVIEW_MAX_POINTS 256
+
+// 点缓存从 BLE 会话 arena 按需分配（3 KB），断线随区域复位归还
+static PreviewPoint *previewPoints = nullptr;
+
+// 整文件流式解码 + 径向距离抽稀。点数超出缓存时隔点丢一半并把
+// epsilon 翻倍继续，最终点集 ≤ 256 且大致均匀
+bool FileTransferProtocol::buildTrackPreview(const char *path,
+                                             uint16_t epsilonM) {
+  if (previewPoints == nullptr) {
+    previewPoints = (PreviewPoint *)bleSessionArena().alloc(
+        PREVIEW_MAX_POINTS * sizeof(PreviewPoint));
+    if (previewPoints == nullptr) {
+      Log.println("预览: 会话 arena 耗尽");
+      return false;
+    }
+  }
+
+  SdFile f;
+  if (!f.open(path, O_READ)) {
+    return false;
+  }
+
+  GpsDataDecoder decoder;
+  TrackSimplifier simplifier;
+  uint16_t eps = (epsilonM == 0) ? 10 : epsilonM;
+  simplifier.reset(eps);
+
+  uint8_t chunk[512];
+  size_t fill = 0;
+  uint16_t count = 0;
+  GpxPointInternalV2 pt;
+  GpxPointInternalV2 lastPt;
+  bool havePoint = false;
+  bool lastKept = false;
+
+  for (;;) {
+    int n = f.read(chunk + fill, sizeof(chunk) - fill);
+    if (n > 0) {
+      fill += n;
+    }
+
+    size_t pos = 0;
+    uint32_t consumed;
+    while ((consumed = decoder.decodeNext(chunk + pos, fill - pos, &pt)) > 0) {
+      pos += consumed;
+      havePoint = true;
+      lastPt = pt;
+      lastKept = simplifier.offer(pt);
+      if (!lastKept) {
+        continue;
+      }
+      if (count == PREVIEW_MAX_POINTS) {
+        // 缓存满：隔点保留一半，epsilon 翻倍后继续
+        for (uint16_t i = 0; i < PREVIEW_MAX_POINTS / 2; i++) {
+          previewPoints[i] = previewPoints[i * 2];
+        }
+        count = PREVIEW_MAX_POINTS / 2;
+        eps = (eps < 0x8000) ? (uint16_t)(eps * 2) : eps;
+        simplifier.widenEpsilon(eps);
+      }
+      previewPoints[count].timestamp = pt.timestamp;
+      previewPoints[count].lat_1e7 = pt.latitude_scaled_1e7;
+      previewPoints[count].lon_1e7 = pt.longitude_scaled_1e7;
+      count++;
+    }
+
+    if (pos == 0 && n <= 0) {
+      break; // EOF 且没有可解码数据
+    }
+    if (pos == 0 && fill == sizeof(chunk)) {
+      Log.println("预览: GPZ 数据损坏，中止解码");
+      break; // 整块都解不出一个块，文件损坏
+    }
+    // 残留的不完整块移到头部，下一轮补读
+    memmove(chunk, chunk + pos, fill - pos);
+    fill -= pos;
+  }
+  f.close();
+
+  // 终点始终保留，概览的折线端点才对得上
+  if (havePoint && !lastKept && count < PREVIEW_MAX_POINTS) {
+    previewPoints[count].timestamp = lastPt.timestamp;
+    previewPoints[count].lat_1e7 = lastPt.latitude_scaled_1e7;
+    previewPoints[count].lon_1e7 = lastPt.longitude_scaled_1e7;
+    count++;
+  }
+
+  strncpy(_previewPath, path, MAX_PATH_LENGTH - 1);
+  _previewPath[MAX_PATH_LENGTH - 1] = '\0';
+  _previewEpsilonM = epsilonM;
+  _previewCount = count;
+  _previewValid = true;
+  Log.printf("预览: %s eps=%um -> %u 点\n", path, (unsigned)eps,
+             (unsigned)count);
+  return true;
+}
+
+// CMD_GET_TRACK_PREVIEW：载荷 [pathLen:1][path][epsilon_m:2][offset:2]。
+// offset=0 或文件/epsilon 变化时重新解码抽稀（10k 点的整天文件
+// 数百毫秒量级），之后翻页直接读缓存。
+// 响应: [total:2][offset:2][n:1] + n × [ts:4][lat_1e7:4][lon_1e7:4]
+void FileTransferProtocol::processGetTrackPreview() {
+  if (_payloadLength < 1) {
+    sendResponse(nullptr, 0);
+    return;
+  }
+  uint8_t pathLength = _buffer[0];
+  if (pathLength == 0 || pathLength >= MAX_PATH_LENGTH ||
+      _payloadLength < (uint16_t)(1 + pathLength + 4)) {
+    Log.println("GET_TRACK_PREVIEW: 载荷无效");
+    sendResponse(nullptr, 0);
+    return;
+  }
+  char path[MAX_PATH_LENGTH];
+  memset(path, 0, MAX_PATH_LENGTH);
+  memcpy(path, &_buffer[1], pathLength);
+  uint16_t epsilonM, offset;
+  memcpy(&epsilonM, &_buffer[1 + pathLength], 2);
+  memcpy(&offset, &_buffer[1 + pathLength + 2], 2);
+
+  if (!_previewValid || strcmp(path, _previewPath) != 0 ||
+      epsilonM != _previewEpsilonM) {
+    if (!buildTrackPreview(path, epsilonM)) {
+      Log.printf("GET_TRACK_PREVIEW: 无法打开 %s\n", path);
+      sendResponse(nullptr, 0);
+      return;
+    }
+  }
+
+  // 每页点数受响应帧限制：(568 - 5) / 12
+  const uint8_t maxPerPage = 46;
+  uint8_t responseBuffer[5 + maxPerPage * sizeof(PreviewPoint)];
+  uint16_t responseLength = 0;
+  memcpy(&responseBuffer[responseLength], &_previewCount, 2);
+  responseLength += 2;
+  memcpy(&responseBuffer[responseLength], &offset, 2);
+  responseLength += 2;
+  uint16_t countPos = responseLength++;
+
+  uint8_t n = 0;
+  for (uint16_t i = offset; i < _previewCount && n < maxPerPage; i++, n++) {
+    memcpy(&responseBuffer[responseLength], &previewPoints[i],
+           sizeof(PreviewPoint));
+    responseLength += sizeof(PreviewPoint);
+  }
+  responseBuffer[countPos] = n;
+  sendResponse(responseBuffer, responseLength);
+}
+
+// BULK_OFFLOAD：整文件裸流下载。READ_RANGE 每 512 字节块要花
+// 2 字节序号帧 + 2 字节长度帧 + 客户端额度往返，多 GB 级整卡导出
+// 时协议开销和往返空窗吃掉大半吞吐。这条命令只回一个带帧头的起始
+// 响应，之后的文件字节不再分帧、不带序号，大块顺序读出直接填 TX
+// 环，由 MTU 打包发送；流尾附 4 字节全流 CRC32 供客户端校验。
+// 客户端按头里的 totalLen 计数接收，出错只能整流重来——这是用
+// 可恢复性换吞吐的刻意取舍，断点续传场景仍走 READ_RANGE。
+//
+// 载荷: [pathLen:1][path][offset:4 LE][length:4 LE, 0=到文件尾][flags:1 可选]
+//   flags bit0 = 请求 LZ 打包（预留：GPZ 本身已是增量压缩，再包一层
+//   收益不抵 CPU，当前固件忽略该位并在响应 flags 里回显实际模式）
+// 响应: [flags:1][totalLen:4 LE]，之后 totalLen 字节裸数据 + [crc32:4 LE]。
+// pathLen=0 表示取消进行中的裸流（响应 totalLen=0）。
+// 裸流期间不要再发其他命令：带帧响应会混进裸字节里。
+void FileTransferProtocol::processBulkOffload() {
+  if (_payloadLength < 1) {
+    sendResponse(nullptr, 0);
+    return;
+  }
+  uint8_t pathLength = _buffer[0];
+
+  uint8_t responseBuffer[5];
+  if (pathLength == 0) {
+    // 取消语义：客户端中途放弃时让设备立刻停读 SD
+    cancelBulkOffload();
+    responseBuffer[0] = 0;
+    memset(&responseBuffer[1], 0, 4);
+    sendResponse(responseBuffer, 5);
+    return;
+  }
+
+  if (pathLength >= MAX_PATH_LENGTH ||
+      _payloadLength < (uint16_t)(1 + pathLength + 8)) {
+    Log.println("BULK_OFFLOAD: 载荷长度无效");
+    sendResponse(nullptr, 0);
+    return;
+  }
+  if (_bulkActive || _rangeActive || _missingIndex < _missingCount) {
+    // 和分帧推流互斥：两种流混在同一条 NUS 上客户端没法拆
+    Log.println("BULK_OFFLOAD: 已有进行中的传输");
+    sendResponse(nullptr, 0);
+    return;
+  }
+
+  char path[MAX_PATH_LENGTH];
+  memcpy(path, &_buffer[1], pathLength);
+  path[pathLength] = '\0';
+
+  uint32_t offset, length;
+  memcpy(&offset, &_buffer[1 + pathLength], 4);
+  memcpy(&length, &_buffer[1 + pathLength + 4], 4);
+
+  if (!_bulkFile.open(path, O_READ)) {
+    Log.printf("BULK_OFFLOAD: 无法打开文件 %s\n", path);
+    sendResponse(nullptr, 0);
+    return;
+  }
+  uint32_t fileSize = _bulkFile.fileSize();
+  if (offset >= fileSize) {
+    Log.printf("BULK_OFFLOAD: offset %lu 超出文件大小 %lu\n", offset, fileSize);
+    _bulkFile.close();
+    sendResponse(nullptr, 0);
+    return;
+  }
+  if (length == 0 || length > fileSize - offset) {
+    length = fileSize - offset;
+  }
+
+  _bulkActive = true;
+  _bulkOffset = offset;
+  _bulkEnd = offset + length;
+  _bulkCrc = 0;
+
+  responseBuffer[0] = 0; // 实际模式：raw（LZ 位预留）
+  memcpy(&responseBuffer[1], &length, 4);
+  sendResponse(responseBuffer, 5);
+
+  Log.printf("BULK_OFFLOAD: %s offset=%lu len=%lu\n", path, offset, length);
+  serviceBulkOffload();
+}
+
+// 在 TX 环的空间内大块顺序读出、直接入环。环满即停（不忙等），
+// 周期服务（BleHandler::service → serviceTransfers）会再回来续。
+// SdFat 的顺序预读和 SoftDevice 的发包排空由此自然重叠。
+void FileTransferProtocol::serviceBulkOffload() {
+  uint8_t chunkBuffer[512];
+
+  while (_bulkActive && _bulkOffset < _bulkEnd) {
+    uint32_t remaining = _bulkEnd - _bulkOffset;
+    uint16_t toRead = sizeof(chunkBuffer);
+    if (remaining < toRead) {
+      toRead = (uint16_t)remaining;
+    }
+    // 整块放不下就等下一轮，保持大块写入（半块会把读切碎）
+    if (_stream->availableForWrite() < (int)toRead) {
+      break;
+    }
+
+    if (!_bulkFile.seekSet(_bulkOffset)) {
+      Log.println("BULK_OFFLOAD: seek失败，中止");
+      cancelBulkOffload();
+      return;
+    }
+    int bytesRead = _bulkFile.read(chunkBuffer, toRead);
+    if (bytesRead <= 0) {
+      Log.println("BULK_OFFLOAD: 读取失败，中止");
+      cancelBulkOffload();
+      return;
+    }
+
+    if (_stream->write(chunkBuffer, bytesRead) == 0) {
+      break; // 环满（并发生产者抢了空间），下一轮再续
+    }
+    _bulkCrc = crc32_update(_bulkCrc, chunkBuffer, bytesRead);
+    _bulkOffset += bytesRead;
+  }
+
+  if (_bulkActive && _bulkOffset >= _bulkEnd) {
+    // 数据走完，补 CRC 尾。环里放不下 4 字节就留到下一轮
+    uint8_t trailer[4];
+    memcpy(trailer, &_bulkCrc, 4);
+    if (_stream->write(trailer, 4) != 0) {
+      _bulkFile.close();
+      _bulkActive = false;
+      Log.println("BULK_OFFLOAD: 完成");
+    }
+  }
+  _stream->flush(); // 尽力发一轮，不等待
+}
+
+void FileTransferProtocol::cancelBulkOffload() {
+  if (!_bulkActive) {
+    return;
+  }
+  _bulkFile.close();
+  _bulkActive = false;
+  Log.println("BULK_OFFLOAD: 已中止");
+}
+
+void FileTransferProtocol::releaseSessionBuffers() {
+  invalidateDirSnapshot();
+  _previewValid = false;
+  _dirSnapshot = nullptr;
+  previewPoints = nullptr;
+  bleSessionArena().reset(); // 会话内全部分配一次性归还
+}
+
+// CMD_RECENT_TRACK：载荷 [startTs:4][endTs:4][pagePos:4]。
+// endTs=0 表示「到当前为止」；pagePos=0xFFFFFFFF 表示首页（按时间
+// 解析起点），之后客户端用上一响应的 pos+本页字节数续读。
+// 响应: [status:1][pos:4][remaining:4][数据]，status 见 sd_handler.h
+// 的 RECENT_TRACK_*；另加 3 = pagePos 已失效（已按区间起点重定位，
+// 客户端以响应里的 pos 为准重新累计）。
+// 数据直接来自 RAM 环，整个过程零 SD I/O；status=2 时客户端退回
+// READ_TIME_RANGE + READ_RANGE 的卡上路径
+void FileTransferProtocol::processRecentTrack() {
+  // 每页字节数：响应头 9B + 数据要装进一个协议帧
+  const uint16_t pageBytes = 448;
+
+  if (_payloadLength < 12) {
+    Log.println("RECENT_TRACK: 载荷长度无效");
+    sendResponse(nullptr, 0);
+    return;
+  }
+  uint32_t startTs, endTs, pagePos;
+  memcpy(&startTs, &_buffer[0], 4);
+  memcpy(&endTs, &_buffer[4], 4);
+  memcpy(&pagePos, &_buffer[8], 4);
+
+  // 每页都按时间重解析区间：扫描 ≤24 条块引用，微秒级；传输中
+  // 有新全量块落环时终点顺带前移，客户端拿到的是更新的数据
+  uint32_t spanPos = 0, spanEnd = 0;
+  uint8_t status = recentTrackResolve(startTs, endTs, &spanPos, &spanEnd);
+
+  uint8_t responseBuffer[9 + pageBytes];
+  uint16_t offset = 0;
+  uint8_t dataPos = 9; // status + pos + remaining 之后
+
+  if (status == RECENT_TRACK_MISS) {
+    uint32_t zero = 0;
+    responseBuffer[0] = status;
+    memcpy(&responseBuffer[1], &zero, 4);
+    memcpy(&responseBuffer[5], &zero, 4);
+    sendResponse(responseBuffer, 9);
+    return;
+  }
+
+  uint32_t pos = (pagePos == 0xFFFFFFFF) ? spanPos : pagePos;
+  if (pos < spanPos || pos > spanEnd) {
+    pos = spanPos; // 续读位置已被淘汰出区间，从头来
+    status = 3;
+  }
+
+  uint32_t remaining = spanEnd - pos;
+  uint16_t n = (remaining < pageBytes) ? (uint16_t)remaining : pageBytes;
+  if (n > 0 && !recentTrackRead(pos, &responseBuffer[dataPos], n)) {
+    // 拷贝期间被生产者覆盖（理论窗口，增量 0.7 B/s 实际碰不到）
+    n = 0;
+    status = 3;
+  }
+
+  remaining -= n;
+  responseBuffer[0] = status;
+  memcpy(&responseBuffer[1], &pos, 4);
+  memcpy(&responseBuffer[5], &remaining, 4);
+  offset = dataPos + n;
+  sendResponse(responseBuffer, offset);
+}
+
+void FileTransferProtocol::stopSysInfoNotify() {
+  _sysinfoNotifyEnabled = false;
+  _sysinfoForceFull = false;
+}
+
+// 通知载荷: [0x5A][bitmap:1] 之后按位序拼接变化的字段：
+//   bit0 位置 lat_1e7:i32 + lon_1e7:i32（阈值 1e-5 度 = 100）
+//   bit1 海拔 alt_cm:i32（阈值 1 m）
+//   bit2 卫星数 u8
+//   bit3 hdop*100:u16（阈值 0.2）
+//   bit4 速度*10:u16（阈值 0.5 km/h）
+//   bit5 状态机状态 u8（任何变化）
+//   bit6 电池 mV:u16（阈值 10 mV）
+//   bit7 有效位标志 u8（任何变化）
+// 没有字段越过阈值就整帧不发——空中字节数只为真正变了的数据花
+void FileTransferProtocol::serviceSysInfoNotify() {
+  if (!_sysinfoNotifyEnabled || _bulkActive) {
+    return; // 裸流期间不能往流里混带帧通知
+  }
+  uint32_t now = millis();
+  if ((uint32_t)(now - _sysinfoLastNotifyMs) < _sysinfoMinIntervalMs) {
+    return;
+  }
+
+  SysInfoSnapshot cur;
+  quantizeSysInfo(cur);
+
+  uint8_t bitmap = 0;
+  if (_sysinfoForceFull) {
+    bitmap = 0xFF;
+  } else {
+    if (abs(cur.lat_1e7 - _sysinfoLastSent.lat_1e7) > 100 ||
+        abs(cur.lon_1e7 - _sysinfoLastSent.lon_1e7) > 100)
+      bitmap |= 0x01;
+    if (abs(cur.alt_cm - _sysinfoLastSent.alt_cm) > 100)
+      bitmap |= 0x02;
+    if (cur.satellites != _sysinfoLastSent.satellites)
+      bitmap |= 0x04;
+    if (abs((int)cur.hdop_scaled_1e2 - (int)_sysinfoLastSent.hdop_scaled_1e2) >
+        20)
+      bitmap |= 0x08;
+    if (abs((int)cur.speed_scaled_1e1 -
+            (int)_sysinfoLastSent.speed_scaled_1e1) > 5)
+      bitmap |= 0x10;
+    if (cur.gpsState != _sysinfoLastSent.gpsState)
+      bitmap |= 0x20;
+    if (abs((int)cur.battery_mv - (int)_sysinfoLastSent.battery_mv) > 10)
+      bitmap |= 0x40;
+    if (cur.flags != _sysinfoLastSent.flags)
+      bitmap |= 0x80;
+  }
+
+  if (bitmap == 0) {
+    return; // 没有值得上报的变化
+  }
+
+  uint8_t notify[2 + 8 + 4 + 1 + 2 + 2 + 1 + 2 + 1];
+  uint16_t offset = 0;
+  notify[offset++] = SYSINFO_NOTIFY_MAGIC;
+  notify[offset++] = bitmap;
+  if (bitmap & 0x01) {
+    memcpy(&notify[offset], &cur.lat_1e7, 4);
+    offset += 4;
+    memcpy(&notify[offset], &cur.lon_1e7, 4);
+    offset += 4;
+  }
+  if (bitmap & 0x02) {
+    memcpy(&notify[offset], &cur.alt_cm, 4);
+    offset += 4;
+  }
+  if (bitmap & 0x04) {
+    notify[offset++] = cur.satellites;
+  }
+  if (bitmap & 0x08) {
+    memcpy(&notify[offset], &cur.hdop_scaled_1e2, 2);
+    offset += 2;
+  }
+  if (bitmap & 0x10) {
+    memcpy(&notify[offset], &cur.speed_scaled_1e1, 2);
+    offset += 2;
+  }
+  if (bitmap & 0x20) {
+    notify[offset++] = cur.gpsState;
+  }
+  if (bitmap & 0x40) {
+    memcpy(&notify[offset], &cur.battery_mv, 2);
+    offset += 2;
+  }
+  if (bitmap & 0x80) {
+    notify[offset++] = cur.flags;
+  }
+
+  sendResponse(notify, offset);
+
+  // 只更新实际发出去的字段基线，没发的字段继续相对旧基线累积偏差，
+  // 慢漂移不会因为每次都差一点点而永远报不出来
+  if (bitmap & 0x01) {
+    _sysinfoLastSent.lat_1e7 = cur.lat_1e7;
+    _sysinfoLastSent.lon_1e7 = cur.lon_1e7;
+  }
+  if (bitmap & 0x02)
+    _sysinfoLastSent.alt_cm = cur.alt_cm;
+  if (bitmap & 0x04)
+    _sysinfoLastSent.satellites = cur.satellites;
+  if (bitmap & 0x08)
+    _sysinfoLastSent.hdop_scaled_1e2 = cur.hdop_scaled_1e2;
+  if (bitmap & 0x10)
+    _sysinfoLastSent.speed_scaled_1e1 = cur.speed_scaled_1e1;
+  if (bitmap & 0x20)
+    _sysinfoLastSent.gpsState = cur.gpsState;
+  if (bitmap & 0x40)
+    _sysinfoLastSent.battery_mv = cur.battery_mv;
+  if (bitmap & 0x80)
+    _sysinfoLastSent.flags = cur.flags;
+  _sysinfoForceFull = false;
+  _sysinfoLastNotifyMs = now;
 }
 
 void FileTransferProtocol::processStartAgnssWrite() {
-  // 开始 AGNSS 数据写入传输
-  _agnssMessages.clear(); // 清空之前的数据
+  // 开始 AGNSS 数据写入传输：复位固定环，准备流式接收
+  agnssRing.reset();
   _agnssWriteInProgress = true;
 
   Log.println("开始 AGNSS 数据写入");
@@ -486,16 +1658,21 @@ void FileTransferProtocol::processWriteAgnssChunk() {
     return;
   }
 
-  // 创建新的消息向量并复制数据
-  std::vector<uint8_t> message;
-  message.resize(chunkSize);
-  memcpy(message.data(), &_buffer[2], chunkSize);
-
-  // 将消息添加到队列中
-  _agnssMessages.push_back(message);
+  // 消息入固定环。环满时回 1 字节 0x01 做背压——此时 S5 正在
+  // 消费，客户端稍后重发该块即可（空响应仍表示接收成功）
+  if (!agnssRing.push(&_buffer[2], chunkSize)) {
+    Log.printf("AGNSS 环已满（空闲 %d 字节），请求客户端重试\n",
+               (int)agnssRing.freeBytes());
+    uint8_t busy = 0x01;
+    sendResponse(&busy, 1);
+    return;
+  }
 
   Log.printf("接收 AGNSS 数据块，大小: %d，总块数: %d\n", chunkSize,
-             (int)_agnssMessages.size());
+             (int)agnssRing.pushedCount());
+
+  // 第一块落环即可唤起 S5：注入与后续块的接收并行
+  notifyAgnssStreamActive();
 
   // 发送空响应表示接收成功
   sendResponse(nullptr, 0);
@@ -511,19 +1688,15 @@ void FileTransferProtocol::processEndAgnssWrite() {
   _agnssWriteInProgress = false;
 
   Log.printf("结束 AGNSS 数据写入，共接收 %d 个数据块\n",
-             (int)_agnssMessages.size());
+             (int)agnssRing.pushedCount());
 
-  // 将 AGNSS 消息队列设置到 GPS 处理器
-  if (!_agnssMessages.empty()) {
-    setAgnssMessageQueue(_agnssMessages);
-    Log.println("AGNSS 数据已发送到 GPS 处理器");
+  // 标记流结束：S5 把环排空后即完成本轮注入
+  if (agnssRing.pushedCount() > 0) {
+    agnssRing.setStreamDone(true);
   } else {
     Log.println("警告：没有接收到 AGNSS 数据");
   }
 
-  // 清空消息队列
-  _agnssMessages.clear();
-
   // 发送空响应表示完成
   sendResponse(nullptr, 0);
 }
@@ -2,7 +2,6 @@
 #include "Stream.h"
 #include "SdFat.h"
 #include <Arduino.h>
-#include <vector>
 
 // Use SdFat instead of LittleFS
 extern SdFat sd;
@@ -18,6 +17,24 @@ extern SdFat sd;
 #define CMD_END_AGNSS_WRITE 0x09
 #define CMD_GPS_WAKEUP 0x0A
 
+// 0x0B - 0x1F 预留给 uart_file_proto.md 的后续扩展。
+// 流式/诊断类扩展命令从 0x20 开始（见 docs/uart_file_proto_ext.md）。
+#define CMD_READ_RANGE 0x20   // 流式读取文件区间（带序号推送）
+#define CMD_RANGE_CREDIT 0x21 // 为进行中的 READ_RANGE 补充发送额度
+#define CMD_GET_TRANSFER_STATE 0x22 // 查询传输会话（断线重连后恢复用）
+#define CMD_READ_MISSING 0x23 // 稀疏重传：按偏移补发缺失区间
+#define CMD_SYSINFO_SUBSCRIBE 0x24 // 订阅系统信息变化通知（增量推送）
+#define CMD_GET_PERF_STATS 0x25 // 导出各任务的延迟直方图（诊断用）
+#define CMD_GET_BATTERY_LOG 0x26 // 分页导出电池遥测环（电压/负载/SoC）
+#define CMD_GET_CRASH_LOG 0x27 // 读取/清除持久化的故障飞行记录
+#define CMD_READ_TIME_RANGE 0x28 // 时间范围 → 字节范围（配合 READ_RANGE）
+#define CMD_GET_TRACK_PREVIEW 0x29 // 设备端抽稀的航迹预览（分页）
+#define CMD_BULK_OFFLOAD 0x2A // 整文件裸流下载（单头 + 裸字节流 + CRC 尾）
+#define CMD_RECENT_TRACK 0x2B // 最近航迹时间段查询（RAM 环直答，零 SD I/O）
+
+// 系统信息通知的魔数首字节，区别于普通命令响应
+#define SYSINFO_NOTIFY_MAGIC 0x5A
+
 // 目录项类型
 #define ENTRY_TYPE_FILE 0x00
 #define ENTRY_TYPE_DIRECTORY 0x01
@@ -31,6 +48,21 @@ public:
   void start();
   void process(); // 处理接收到的命令
 
+  // 订阅模式下的周期服务：对比快照，只推送越过阈值的字段。
+  // 由主循环调度任务定期调用（见 BleHandler::service）
+  void serviceSysInfoNotify();
+  void stopSysInfoNotify(); // 断线时清掉订阅
+
+  // 续推因 TX 环背压暂停的区间传输/稀疏重传（同样由周期服务调用）
+  void serviceTransfers();
+
+  // 断线时中止进行中的裸流下载（见 BleHandler::disconnect_callback）
+  void cancelBulkOffload();
+
+  // 断线时归还 BLE 会话 arena 里的缓存（目录快照、预览点）。
+  // 释放即整区域复位——这就是会话区域存在的意义
+  void releaseSessionBuffers();
+
 private:
   Stream *_stream;
   SdFile _currentOpenFile;
@@ -45,10 +77,75 @@ private:
   bool _dirOpen;
   bool _listingInProgress;
 
-  // AGNSS 相关变量
-  std::vector<std::vector<uint8_t>> _agnssMessages;
+  // LIST_DIR 分页快照：首页时整目录走一遍 FAT，只记下每个条目的
+  // 目录项索引（2B/条），后续页用 open-by-index 直达，不再重走。
+  // 索引数组从 BLE 会话 arena 按需分配（500 个日志文件占 1 KB），
+  // 断线时随区域复位归还
+  static const uint16_t DIR_SNAPSHOT_MAX = 512;
+  uint16_t *_dirSnapshot;
+  uint16_t _dirSnapshotCount;
+  bool _dirSnapshotValid;
+  char _dirSnapshotPath[MAX_PATH_LENGTH];
+
+  // GET_TRACK_PREVIEW 结果缓存（点数据本体在 .cpp 的静态缓冲里）：
+  // 同一文件/epsilon 的翻页不重新解码
+  bool _previewValid;
+  char _previewPath[MAX_PATH_LENGTH];
+  uint16_t _previewEpsilonM;
+  uint16_t _previewCount;
+
+  // AGNSS 相关变量（数据本体在 agnssRing 固定环里，这里只留会话标志）
   bool _agnssWriteInProgress;
 
+  // READ_RANGE 流式传输状态
+  bool _rangeActive;       // 是否有进行中的区间传输
+  uint32_t _rangeOffset;   // 下一个要发送的文件偏移
+  uint32_t _rangeEnd;      // 区间结束偏移（不含）
+  uint16_t _rangeChunkSize; // 每个数据块的大小
+  uint16_t _rangeSeq;      // 下一个数据块的序号
+  uint8_t _rangeCredits;   // 剩余发送额度（客户端授予）
+  bool _rangeWithCrc;      // 每块数据是否附带 CRC32 尾部
+
+  // 传输会话状态（跨 BLE 断线保留，支持断点续传）
+  uint16_t _transferId;                 // 当前会话 ID，每次 OPEN_FILE 递增
+  char _openFilePath[MAX_PATH_LENGTH];  // 当前打开文件的路径
+
+  // 稀疏重传队列（客户端按位图报告的缺失区间）
+  static const uint8_t MAX_MISSING_RANGES = 8;
+  struct MissingRange {
+    uint32_t offset;
+    uint32_t length;
+  };
+  MissingRange _missingRanges[MAX_MISSING_RANGES];
+  uint8_t _missingCount;
+  uint8_t _missingIndex;
+
+  // BULK_OFFLOAD 裸流状态。用独立的 SdFile，不打扰 OPEN_FILE 会话；
+  // 头之后的数据不再带 [LEN:2] 帧和块序号，整流只有一个 CRC32 尾
+  bool _bulkActive;
+  SdFile _bulkFile;
+  uint32_t _bulkOffset; // 下一个要入环的文件偏移
+  uint32_t _bulkEnd;    // 流结束偏移（不含）
+  uint32_t _bulkCrc;    // 全流 CRC32 的滚动值
+
+  // SYSINFO_SUBSCRIBE 订阅状态：记录上次推送的量化值，
+  // 只有字段越过阈值才进通知（位图标记本次携带哪些字段）
+  bool _sysinfoNotifyEnabled;
+  uint16_t _sysinfoMinIntervalMs; // 两次通知的最小间隔
+  uint32_t _sysinfoLastNotifyMs;
+  bool _sysinfoForceFull; // 刚订阅时推一帧全量快照
+  struct SysInfoSnapshot {
+    int32_t lat_1e7;
+    int32_t lon_1e7;
+    int32_t alt_cm;
+    uint8_t satellites;
+    uint16_t hdop_scaled_1e2;
+    uint16_t speed_scaled_1e1;
+    uint8_t gpsState;
+    uint16_t battery_mv;
+    uint8_t flags; // bit0 locationValid, bit1 dateTimeValid, bit2 isStationary
+  } _sysinfoLastSent;
+
   // 命令解析状态
   enum CommandState {
     WAIT_CMD_ID,
@@ -60,6 +157,9 @@ private:
 
   // 协议处理方法
   void processListDir();
+  void processListDirPaged(const char *path, uint16_t offset, uint8_t count);
+  bool rebuildDirSnapshot(const char *path);
+  void invalidateDirSnapshot();
   void processOpenFile();
   void processReadChunk();
   void processCloseFile();
@@ -74,6 +174,43 @@ private:
   // GPS 唤醒处理方法
   void processGpsWakeup();
 
+  // READ_RANGE 流式传输处理方法
+  void processReadRange();
+  void processRangeCredit();
+  void serviceRangeTransfer(); // 在额度内连续推送数据块
+
+  // 断点续传处理方法
+  void processGetTransferState();
+  void processReadMissing();
+  void serviceMissingRanges(); // 在额度内补发缺失区间
+
+  // 系统信息订阅处理方法
+  void processSysInfoSubscribe();
+  void quantizeSysInfo(SysInfoSnapshot &snap) const;
+
+  // 性能统计导出
+  void processGetPerfStats();
+
+  // 电池遥测环分页导出
+  void processGetBatteryLog();
+
+  // 故障飞行记录导出
+  void processGetCrashLog();
+
+  // GPZ 时间范围解析
+  void processReadTimeRange();
+
+  // 航迹预览（设备端解码 + 流式抽稀，结果缓存分页导出）
+  void processGetTrackPreview();
+  bool buildTrackPreview(const char *path, uint16_t epsilonM);
+
+  // 整文件裸流下载
+  void processBulkOffload();
+  void serviceBulkOffload(); // 把大块顺序读出的裸字节填满 TX 环
+
+  // 最近航迹 RAM 环分页导出
+  void processRecentTrack();
+
   // 辅助方法
   void sendResponse(uint8_t *payload, uint16_t length);
   void resetState();
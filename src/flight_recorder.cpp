@@ -0,0 +1,139 @@
+#include "flight_recorder.h"
+#include "Adafruit_LittleFS.h"
+#include "InternalFileSystem.h"
+#include "crc32.h"
+#include "log_ring.h"
+#include "logger.h"
+#include "system_info.h"
+#include <Arduino.h>
+#include <nrf.h>
+#include <string.h>
+
+using namespace Adafruit_LittleFS_Namespace;
+
+#define CRASH_PATH "/crash.bin"
+#define FLIGHT_RECORD_MAGIC 0x464C5231 // "FLR1"
+
+// .noinit：链接脚本里的 NOLOAD 段，软复位后内容保留。
+// C 运行时不清零也不初始化，有效性全靠魔数 + CRC 判定
+__attribute__((section(".noinit"))) static FlightFaultRecord faultRecord;
+
+static uint32_t recordCrc(const FlightFaultRecord &rec) {
+  return crc32_calc(&rec, sizeof(rec) - 4);
+}
+
+// 故障上下文里跑的捕获逻辑：只碰 RAM，不碰外设/文件系统/锁。
+// stackFrame 是异常压栈帧 [r0 r1 r2 r3 r12 lr pc xpsr]
+extern "C" void flightRecorderCapture(uint32_t *stackFrame,
+                                      uint32_t faultType) {
+  FlightFaultRecord &rec = faultRecord;
+  rec.faultType = (uint8_t)faultType;
+  rec.gpsState = (uint8_t)gSystemInfo.gpsState;
+  rec.uptimeMs = millis();
+  rec.r0 = stackFrame[0];
+  rec.r1 = stackFrame[1];
+  rec.r2 = stackFrame[2];
+  rec.r3 = stackFrame[3];
+  rec.r12 = stackFrame[4];
+  rec.lr = stackFrame[5];
+  rec.pc = stackFrame[6];
+  rec.xpsr = stackFrame[7];
+  rec.cfsr = SCB->CFSR;
+  rec.hfsr = SCB->HFSR;
+  rec.lat_1e7 = gSystemInfo.latitude_scaled_1e7;
+  rec.lon_1e7 = gSystemInfo.longitude_scaled_1e7;
+  rec.alt_cm = gSystemInfo.altitude_cm;
+  rec.battery_mv = (gSystemInfo.batteryVoltage > 0)
+                       ? (uint16_t)(gSystemInfo.batteryVoltage * 1000.0f)
+                       : 0;
+  rec.satellites = (uint8_t)gSystemInfo.satellites;
+  rec.flags = (gSystemInfo.locationValid ? 0x01 : 0) |
+              (gSystemInfo.dateTimeValid ? 0x02 : 0) |
+              (gSystemInfo.isStationary ? 0x04 : 0);
+  rec.logLen =
+      (uint16_t)logRingRawSnapshot(rec.logSnapshot, FLIGHT_LOG_SNAPSHOT_MAX);
+  rec.magic = FLIGHT_RECORD_MAGIC;
+  rec.crc = recordCrc(rec);
+  NVIC_SystemReset();
+}
+
+// 异常入口：判断故障发生时用的是 MSP 还是 PSP（EXC_RETURN bit2），
+// 把对应栈指针和故障类型交给 C 捕获函数
+#define FAULT_HANDLER_BODY(typeNum)                                            \
+  __asm volatile("tst lr, #4          \n"                                      \
+                 "ite eq              \n"                                      \
+                 "mrseq r0, msp       \n"                                      \
+                 "mrsne r0, psp       \n"                                      \
+                 "mov r1, #" #typeNum "\n"                                     \
+                 "b flightRecorderCapture \n")
+
+extern "C" __attribute__((naked)) void HardFault_Handler(void) {
+  FAULT_HANDLER_BODY(1);
+}
+extern "C" __attribute__((naked)) void MemoryManagement_Handler(void) {
+  FAULT_HANDLER_BODY(2);
+}
+extern "C" __attribute__((naked)) void BusFault_Handler(void) {
+  FAULT_HANDLER_BODY(3);
+}
+extern "C" __attribute__((naked)) void UsageFault_Handler(void) {
+  FAULT_HANDLER_BODY(4);
+}
+
+static void persistRecord() {
+  InternalFS.remove(CRASH_PATH);
+  File f(InternalFS);
+  if (!f.open(CRASH_PATH, FILE_O_WRITE)) {
+    Log.println("FlightRec: crash file open failed");
+    return;
+  }
+  size_t written = f.write((const uint8_t *)&faultRecord, sizeof(faultRecord));
+  f.close();
+  if (written != sizeof(faultRecord)) {
+    Log.printf("FlightRec: short write (%d)\n", (int)written);
+    InternalFS.remove(CRASH_PATH);
+    return;
+  }
+  Log.printf("FlightRec: 持久化故障记录 type=%u pc=0x%08lX cfsr=0x%08lX\n",
+             faultRecord.faultType, (unsigned long)faultRecord.pc,
+             (unsigned long)faultRecord.cfsr);
+}
+
+void initFlightRecorder() {
+  // 开启 MemManage/BusFault/UsageFault 细分异常，
+  // 否则全部升级成 HardFault，丢掉故障原因
+  SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk |
+                SCB_SHCSR_USGFAULTENA_Msk;
+
+  if (faultRecord.magic == FLIGHT_RECORD_MAGIC &&
+      faultRecord.crc == recordCrc(faultRecord)) {
+    persistRecord();
+  }
+  // 无论有效与否都清掉，避免残留数据下次被误判
+  faultRecord.magic = 0;
+}
+
+bool flightRecorderHasCrash() {
+  File f(InternalFS);
+  if (!f.open(CRASH_PATH, FILE_O_READ)) {
+    return false;
+  }
+  f.close();
+  return true;
+}
+
+size_t flightRecorderReadCrash(uint8_t *out, size_t cap) {
+  File f(InternalFS);
+  if (!f.open(CRASH_PATH, FILE_O_READ)) {
+    return 0;
+  }
+  size_t toRead = f.size();
+  if (toRead > cap) {
+    toRead = cap;
+  }
+  int n = f.read(out, toRead);
+  f.close();
+  return (n > 0) ? (size_t)n : 0;
+}
+
+void flightRecorderClearCrash() { InternalFS.remove(CRASH_PATH); }
@@ -0,0 +1,54 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 故障飞行记录仪：HardFault/MemManage/BusFault/UsageFault 时把
+// 压栈寄存器、SCB 故障状态、gSystemInfo 关键字段和日志环里
+// 最近的二进制记录抓进 .noinit RAM（复位不清零），随后软复位。
+// 下次启动 initFlightRecorder 校验魔数 + CRC，把记录持久化到
+// LittleFS（/crash.bin），主机通过 GET_CRASH_LOG (0x27) 拉取。
+// 野外设备的莫名复位从「跑一趟现场」变成一次 BLE 查询。
+
+// 日志环快照上限：整条记录（72B 头 + 快照）要装进一个协议响应帧
+#define FLIGHT_LOG_SNAPSHOT_MAX 448
+
+#pragma pack(push, 4)
+struct FlightFaultRecord {
+  uint32_t magic;     // FLIGHT_RECORD_MAGIC
+  uint8_t faultType;  // 1 HardFault, 2 MemManage, 3 BusFault, 4 UsageFault
+  uint8_t gpsState;   // 故障时的状态机状态
+  uint16_t logLen;    // logSnapshot 有效长度
+  uint32_t uptimeMs;  // millis()
+  // 异常压栈帧 + 故障状态寄存器
+  uint32_t r0, r1, r2, r3, r12, lr, pc, xpsr;
+  uint32_t cfsr; // SCB->CFSR（MemManage/BusFault/UsageFault 细分原因）
+  uint32_t hfsr; // SCB->HFSR
+  // gSystemInfo 关键字段
+  int32_t lat_1e7;
+  int32_t lon_1e7;
+  int32_t alt_cm;
+  uint16_t battery_mv;
+  uint8_t satellites;
+  uint8_t flags; // bit0 locationValid, bit1 dateTimeValid, bit2 isStationary
+  // 日志环原始记录（格式见 log_ring.cpp，主机侧离线格式化）
+  uint8_t logSnapshot[FLIGHT_LOG_SNAPSHOT_MAX];
+  uint32_t crc; // crc32_calc(记录去掉本字段)
+};
+#pragma pack(pop)
+
+// 启动时调用（initInternalFlash 之后）：开启故障细分异常，
+// 发现 .noinit 里有有效记录则落盘并清除魔数
+void initFlightRecorder();
+
+// 是否有已持久化的故障记录（/crash.bin 存在）
+bool flightRecorderHasCrash();
+
+// 读出持久化记录，返回实际字节数（0 = 无记录或读失败）
+size_t flightRecorderReadCrash(uint8_t *out, size_t cap);
+
+// 删除持久化记录（主机取走后清除）
+void flightRecorderClearCrash();
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,128 @@
+#include "gps_data_decoder.h"
+
+GpsDataDecoder::GpsDataDecoder()
+    : previous_point_v1_{}, previous_point_v2_{}, has_previous_v1_(false),
+      has_previous_v2_(false), current_version_(0) {}
+
+void GpsDataDecoder::clear() { *this = GpsDataDecoder(); }
+
+uint32_t GpsDataDecoder::read_uint32_le(const uint8_t *buf) {
+  return static_cast<uint32_t>(buf[0]) | (static_cast<uint32_t>(buf[1]) << 8) |
+         (static_cast<uint32_t>(buf[2]) << 16) |
+         (static_cast<uint32_t>(buf[3]) << 24);
+}
+
+bool GpsDataDecoder::read_varint_s32(const uint8_t *buf, size_t len,
+                                     size_t *offset, int32_t *val) {
+  uint32_t zz = 0;
+  uint8_t shift = 0;
+  size_t pos = *offset;
+  // int32 的 ZigZag varint 最多 5 字节
+  while (pos < len && shift < 35) {
+    uint8_t byte = buf[pos++];
+    zz |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      *offset = pos;
+      *val = static_cast<int32_t>((zz >> 1) ^ (~(zz & 1) + 1));
+      return true;
+    }
+    shift += 7;
+  }
+  return false; // 数据不足或 varint 超长
+}
+
+uint32_t GpsDataDecoder::decodeNext(const uint8_t *buf, size_t len,
+                                    GpxPointInternalV2 *out) {
+  if (buf == nullptr || out == nullptr || len < 1) {
+    return 0;
+  }
+
+  uint8_t header = buf[0];
+  size_t offset = 1;
+
+  // 全量块（V1 0xFF / V2 0xFE）：17 字节定长
+  if (header == 0xFF || header == 0xFE) {
+    if (len < GPZ_MAX_ENCODED_POINT_SIZE) {
+      return 0;
+    }
+    GpxPointInternalV2 point;
+    point.timestamp = read_uint32_le(&buf[1]);
+    int32_t lat = static_cast<int32_t>(read_uint32_le(&buf[5]));
+    int32_t lon = static_cast<int32_t>(read_uint32_le(&buf[9]));
+    point.altitude_m_scaled_1e1 = static_cast<int32_t>(read_uint32_le(&buf[13]));
+    if (header == 0xFF) {
+      // V1 载荷是 1e5 精度，放大到 1e7
+      point.latitude_scaled_1e7 = lat * 100;
+      point.longitude_scaled_1e7 = lon * 100;
+      current_version_ = 1;
+      previous_point_v1_ = point;
+      has_previous_v1_ = true;
+    } else {
+      point.latitude_scaled_1e7 = lat;
+      point.longitude_scaled_1e7 = lon;
+      current_version_ = 2;
+      previous_point_v2_ = point;
+      has_previous_v2_ = true;
+    }
+    *out = point;
+    return GPZ_MAX_ENCODED_POINT_SIZE;
+  }
+
+  // 差分块：0x00-0x0F 为 V1，0x10-0x1F 为 V2，其余头值保留
+  bool is_v2;
+  if ((header & 0xF0) == 0x00) {
+    is_v2 = false;
+  } else if ((header & 0xF0) == 0x10) {
+    is_v2 = true;
+  } else {
+    return 0; // 无效块头
+  }
+
+  // 差分块的版本必须跟随当前段的全量块
+  if (is_v2) {
+    if (current_version_ != 2 || !has_previous_v2_) {
+      return 0;
+    }
+  } else {
+    if (current_version_ != 1 || !has_previous_v1_) {
+      return 0;
+    }
+  }
+
+  GpxPointInternalV2 point = is_v2 ? previous_point_v2_ : previous_point_v1_;
+  uint8_t flags = header & 0x0F;
+  int32_t delta;
+
+  if ((flags >> 3) & 1) { // TS
+    if (!read_varint_s32(buf, len, &offset, &delta)) {
+      return 0;
+    }
+    point.timestamp += static_cast<uint32_t>(delta);
+  }
+  if ((flags >> 2) & 1) { // Lat（V1 差分是 1e5 精度）
+    if (!read_varint_s32(buf, len, &offset, &delta)) {
+      return 0;
+    }
+    point.latitude_scaled_1e7 += is_v2 ? delta : delta * 100;
+  }
+  if ((flags >> 1) & 1) { // Lon
+    if (!read_varint_s32(buf, len, &offset, &delta)) {
+      return 0;
+    }
+    point.longitude_scaled_1e7 += is_v2 ? delta : delta * 100;
+  }
+  if (flags & 1) { // Alt
+    if (!read_varint_s32(buf, len, &offset, &delta)) {
+      return 0;
+    }
+    point.altitude_m_scaled_1e1 += delta;
+  }
+
+  if (is_v2) {
+    previous_point_v2_ = point;
+  } else {
+    previous_point_v1_ = point;
+  }
+  *out = point;
+  return static_cast<uint32_t>(offset);
+}
@@ -0,0 +1,47 @@
+#ifndef GPS_DATA_DECODER_H
+#define GPS_DATA_DECODER_H
+
+#include "gps_data_encoder.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// 流式 GPZ 解码器：GpsDataEncoder 的逆操作，语义与
+// frontend/src/services/gpsDecoder.ts 保持一致（该实现是 V1/V2
+// 混排格式的参考解码器；tools 里的 gps_format.py 目前只认 V1）。
+// 输出统一归一化到 1e7 精度（V1 块按 ×100 放大）。
+// 本文件不依赖 Arduino，可在宿主机上编译（测试/基准用）。
+class GpsDataDecoder {
+public:
+  GpsDataDecoder();
+
+  /**
+   * @brief 从 buf 解出下一个点。
+   * @param buf 输入字节流（从上次消费位置开始）。
+   * @param len buf 中可用的字节数。
+   * @param out 解出的点 (1e7 缩放)。
+   * @return 消费的字节数；0 表示数据不足（等更多字节）或块头无效
+   *         （差分块缺少前置全量块、保留头值），此时 out 不被写入，
+   *         内部状态也不变。
+   */
+  uint32_t decodeNext(const uint8_t *buf, size_t len, GpxPointInternalV2 *out);
+
+  /**
+   * @brief 重置差分状态（换文件时调用）。
+   */
+  void clear();
+
+private:
+  // 读 ZigZag varint；成功时推进 *offset 并返回 true
+  static bool read_varint_s32(const uint8_t *buf, size_t len, size_t *offset,
+                              int32_t *val);
+  static uint32_t read_uint32_le(const uint8_t *buf);
+
+  // V1/V2 各自维护前一个点（与前端解码器一致，段切换时不串基准）
+  GpxPointInternalV2 previous_point_v1_; // 已放大到 1e7
+  GpxPointInternalV2 previous_point_v2_;
+  bool has_previous_v1_;
+  bool has_previous_v2_;
+  uint8_t current_version_; // 0 = 尚无全量块，1 = V1 段，2 = V2 段
+};
+
+#endif // GPS_DATA_DECODER_H
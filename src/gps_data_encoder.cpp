@@ -0,0 +1,185 @@
+#include "gps_data_encoder.h"
+
+// 整数四舍五入除法（divisor > 0）
+static inline int32_t div_round_s32(int32_t val, int32_t divisor) {
+  return (val >= 0) ? (val + divisor / 2) / divisor
+                    : (val - divisor / 2) / divisor;
+}
+
+static inline int32_t abs_s32(int32_t val) { return (val < 0) ? -val : val; }
+
+GpsDataEncoder::GpsDataEncoder(int full_block_interval)
+    : out_(nullptr), out_capacity_(0), out_size_(0), previous_point_{},
+      previous_lat_1e5_(0), previous_lon_1e5_(0),
+      config_full_block_interval_(
+          (full_block_interval < 1) ? 1 : full_block_interval),
+      points_since_last_full_block_(0), is_first_point_(true),
+      segment_is_v2_(true), max_abs_delta_recent_(0) {}
+
+void GpsDataEncoder::write_uint8(uint8_t val) {
+  if (out_size_ < out_capacity_) {
+    out_[out_size_++] = val;
+  }
+}
+
+void GpsDataEncoder::write_uint32_le(uint32_t val) {
+  if (out_size_ + 4 <= out_capacity_) {
+    out_[out_size_++] = static_cast<uint8_t>(val & 0xFF);
+    out_[out_size_++] = static_cast<uint8_t>((val >> 8) & 0xFF);
+    out_[out_size_++] = static_cast<uint8_t>((val >> 16) & 0xFF);
+    out_[out_size_++] = static_cast<uint8_t>((val >> 24) & 0xFF);
+  }
+}
+
+void GpsDataEncoder::write_int32_le(int32_t val) {
+  write_uint32_le(static_cast<uint32_t>(
+      val)); // Cast to uint32_t to preserve bit pattern for negative numbers
+}
+
+void GpsDataEncoder::write_varint_s32(int32_t val) {
+  // ZigZag encoding for int32_t
+  uint32_t zz_val =
+      (static_cast<uint32_t>(val) << 1) ^ (static_cast<uint32_t>(val >> 31));
+
+  // Varint encoding
+  while (zz_val >= 0x80 && out_size_ < out_capacity_) {
+    out_[out_size_++] = static_cast<uint8_t>(zz_val | 0x80);
+    zz_val >>= 7;
+  }
+  if (out_size_ < out_capacity_) {
+    out_[out_size_++] = static_cast<uint8_t>(zz_val);
+  }
+}
+
+uint32_t GpsDataEncoder::encodeTo(const GpxPointInternalV2 &point, uint8_t *out,
+                                  size_t capacity) {
+  // 最大块是 17 字节；容量够就一定能完整写入，不做写入中途的截断
+  if (out == nullptr || capacity < GPZ_MAX_ENCODED_POINT_SIZE) {
+    return 0;
+  }
+  out_ = out;
+  out_capacity_ = capacity;
+  out_size_ = 0;
+
+  // 观测本点相对上一点的经纬度增量幅度 (1e7)，用于段版本决策
+  if (!is_first_point_) {
+    int32_t d_lat =
+        point.latitude_scaled_1e7 - previous_point_.latitude_scaled_1e7;
+    int32_t d_lon =
+        point.longitude_scaled_1e7 - previous_point_.longitude_scaled_1e7;
+    int32_t d_max =
+        (abs_s32(d_lat) > abs_s32(d_lon)) ? abs_s32(d_lat) : abs_s32(d_lon);
+    if (d_max > max_abs_delta_recent_) {
+      max_abs_delta_recent_ = d_max;
+    }
+  }
+
+  bool use_full_block = false;
+
+  if (is_first_point_) {
+    use_full_block = true;
+  } else if (config_full_block_interval_ == 1) {
+    use_full_block = true;
+  } else if (points_since_last_full_block_ >= config_full_block_interval_ - 1) {
+    // After config_full_block_interval_ - 1 DELTA blocks, the next one should
+    // be FULL
+    use_full_block = true;
+  }
+
+  // 本点量化到 1e5（V1 段差分基准；每点重新量化，误差不累积）
+  int32_t lat_1e5 = div_round_s32(point.latitude_scaled_1e7, 100);
+  int32_t lon_1e5 = div_round_s32(point.longitude_scaled_1e7, 100);
+
+  if (use_full_block) {
+    // 段版本选择：上一段增量小（步行/静止）→ V2，精度提升两个数量
+    // 级而增量 varint 依然只有 1-2 字节；增量大（车载）→ V1，避免为
+    // 被点间距淹没的厘米精度多付字节。首点默认 V2（设备通常静止启动）
+    segment_is_v2_ =
+        is_first_point_ || (max_abs_delta_recent_ <= GPZ_V2_SEGMENT_DELTA_MAX_1E7);
+    max_abs_delta_recent_ = 0;
+
+    if (segment_is_v2_) {
+      write_uint8(0xFE); // Header for Full Block V2
+      write_uint32_le(point.timestamp);
+      write_int32_le(point.latitude_scaled_1e7);
+      write_int32_le(point.longitude_scaled_1e7);
+      write_int32_le(point.altitude_m_scaled_1e1);
+    } else {
+      write_uint8(0xFF); // Header for Full Block V1
+      write_uint32_le(point.timestamp);
+      write_int32_le(lat_1e5);
+      write_int32_le(lon_1e5);
+      write_int32_le(point.altitude_m_scaled_1e1);
+    }
+
+    points_since_last_full_block_ = 0; // Reset delta counter
+    is_first_point_ = false;
+  } else {
+    // Write Delta Block（版本跟随本段的全量块）
+    int32_t delta_timestamp =
+        point.timestamp -
+        previous_point_.timestamp; // Note: uint - uint could wrap, but here
+                                   // it's fine for typical deltas.
+    int32_t delta_latitude, delta_longitude;
+    if (segment_is_v2_) {
+      delta_latitude =
+          point.latitude_scaled_1e7 - previous_point_.latitude_scaled_1e7;
+      delta_longitude =
+          point.longitude_scaled_1e7 - previous_point_.longitude_scaled_1e7;
+    } else {
+      delta_latitude = lat_1e5 - previous_lat_1e5_;
+      delta_longitude = lon_1e5 - previous_lon_1e5_;
+    }
+    int32_t delta_altitude =
+        point.altitude_m_scaled_1e1 - previous_point_.altitude_m_scaled_1e1;
+
+    // Delta block header: bit 4 为版本位 (0 = V1, 1 = V2)
+    uint8_t header = segment_is_v2_ ? 0x10 : 0x00;
+    // Bits: 3 (TS), 2 (Lat), 1 (Lon), 0 (Alt)
+    if (delta_timestamp != 0)
+      header |= (1 << 3);
+    if (delta_latitude != 0)
+      header |= (1 << 2);
+    if (delta_longitude != 0)
+      header |= (1 << 1);
+    if (delta_altitude != 0)
+      header |= (1 << 0);
+
+    write_uint8(header);
+
+    if (delta_timestamp != 0)
+      write_varint_s32(delta_timestamp);
+    if (delta_latitude != 0)
+      write_varint_s32(delta_latitude);
+    if (delta_longitude != 0)
+      write_varint_s32(delta_longitude);
+    if (delta_altitude != 0)
+      write_varint_s32(delta_altitude);
+
+    points_since_last_full_block_++;
+  }
+
+  previous_point_ = point;
+  previous_lat_1e5_ = lat_1e5;
+  previous_lon_1e5_ = lon_1e5;
+  uint32_t written = out_size_;
+  out_ = nullptr;
+  out_capacity_ = 0;
+  out_size_ = 0;
+  return written;
+}
+
+uint32_t GpsDataEncoder::encodeTo(const GpxPointInternal &point, uint8_t *out,
+                                  size_t capacity) {
+  // 1e5 -> 1e7 放大是精确的，旧调用方共用同一条编码路径
+  GpxPointInternalV2 v2;
+  v2.timestamp = point.timestamp;
+  v2.latitude_scaled_1e7 = point.latitude_scaled_1e5 * 100;
+  v2.longitude_scaled_1e7 = point.longitude_scaled_1e5 * 100;
+  v2.altitude_m_scaled_1e1 = point.altitude_m_scaled_1e1;
+  return encodeTo(v2, out, capacity);
+}
+
+void GpsDataEncoder::clear() {
+  *this = GpsDataEncoder(config_full_block_interval_);
+}
@@ -0,0 +1,101 @@
+#ifndef GPS_DATA_ENCODER_H
+#define GPS_DATA_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 内部存储的 GPS 航迹点的数据结构 (使用缩放后的整数)
+#pragma pack(push, 1)
+typedef struct {
+  uint32_t timestamp;            // Unix 时间戳 (秒)
+  int32_t latitude_scaled_1e5;   // 纬度 (度 * 10^5)
+  int32_t longitude_scaled_1e5;  // 经度 (度 * 10^5)
+  int32_t altitude_m_scaled_1e1; // 海拔 (米 * 10)
+} GpxPointInternal;
+#pragma pack(pop)
+
+// V2 版本：经纬度 1e7 精度 (~1.1 厘米)，结构体大小不变
+#pragma pack(push, 1)
+typedef struct {
+  uint32_t timestamp;            // Unix 时间戳 (秒)
+  int32_t latitude_scaled_1e7;   // 纬度 (度 * 10^7)
+  int32_t longitude_scaled_1e7;  // 经度 (度 * 10^7)
+  int32_t altitude_m_scaled_1e1; // 海拔 (米 * 10)
+} GpxPointInternalV2;
+#pragma pack(pop)
+
+// 单个点编码后的最大字节数：全量块 = 1字节头 + 16字节载荷。
+// 调用方保证输出区至少有这么多空间即可无条件调用 encodeTo()。
+constexpr size_t GPZ_MAX_ENCODED_POINT_SIZE = 17;
+
+// 段精度策略的阈值：上一段内经纬度每采样的最大 1e7 增量不超过
+// 此值时，新段用 V2（增量 ZigZag 后 ≤ 2 字节 varint，体积几乎与
+// V1 持平，精度多两个数量级）；更大的增量（车载速度）则退回 V1，
+// 此时 1e5 量化噪声远低于点间距，多出来的 V2 字节只是浪费。
+constexpr int32_t GPZ_V2_SEGMENT_DELTA_MAX_1E7 = 8191;
+
+// 流式 GPZ 编码器：把点直接序列化到调用方提供的输出区
+// （SD 写缓存），自身只保留差分状态，不持有任何缓冲区。
+// 本文件不依赖 Arduino，可在宿主机上编译（测试/基准用）。
+class GpsDataEncoder {
+public:
+  /**
+   * @brief Constructs a GpsDataEncoder.
+   * @param full_block_interval How many points between full blocks.
+   * 1 means every point is a full block.
+   * N means 1 full block, then N-1 delta blocks, then 1 full block.
+   * Defaults to 64.
+   */
+  GpsDataEncoder(int full_block_interval = 64);
+
+  /**
+   * @brief 把一个 1e7 精度的点编码进调用方提供的输出区。
+   *        块版本按段自动选择：全量块边界上根据上一段的增量幅度
+   *        决定整段用 V2 (1e7) 还是 V1 (1e5)，见
+   *        GPZ_V2_SEGMENT_DELTA_MAX_1E7。
+   * @param point 要编码的点 (1e7 缩放)。
+   * @param out 输出区起始地址。
+   * @param capacity 输出区可用字节数。
+   * @return 写入的字节数；空间不足（< GPZ_MAX_ENCODED_POINT_SIZE
+   *         且放不下）时返回 0，且不更新差分状态。
+   */
+  uint32_t encodeTo(const GpxPointInternalV2 &point, uint8_t *out,
+                    size_t capacity);
+
+  /**
+   * @brief 1e5 精度入口（兼容旧路径）：放大到 1e7 后走同一编码路径。
+   */
+  uint32_t encodeTo(const GpxPointInternal &point, uint8_t *out,
+                    size_t capacity);
+
+  /**
+   * @brief 重置编码器的差分状态（换文件时调用）。
+   */
+  void clear();
+
+private:
+  // Helper methods for writing data in little-endian format
+  void write_uint8(uint8_t val);
+  void write_uint32_le(uint32_t val);
+  void write_int32_le(int32_t val);
+
+  // Helper for ZigZag encoding then Varint encoding an int32_t
+  void write_varint_s32(int32_t val);
+
+  // encodeTo() 执行期间的输出游标（不跨调用保留）
+  uint8_t *out_;
+  size_t out_capacity_;
+  size_t out_size_;
+
+  GpxPointInternalV2 previous_point_;   // 上一点 (1e7，权威差分基准)
+  int32_t previous_lat_1e5_;            // 上一点量化到 1e5（V1 段差分基准，
+  int32_t previous_lon_1e5_;            // 防止量化误差随段累积）
+  int config_full_block_interval_;
+  int points_since_last_full_block_; // Counts DELTA blocks written since last
+                                     // FULL block
+  bool is_first_point_;
+  bool segment_is_v2_;            // 当前段的块版本
+  int32_t max_abs_delta_recent_;  // 本段内观测到的最大经纬度增量 (1e7)
+};
+
+#endif // GPS_DATA_ENCODER_H
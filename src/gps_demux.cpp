@@ -0,0 +1,130 @@
+#include "gps_demux.h"
+
+GpsStreamDemux::GpsStreamDemux() : _length(0), _scanPos(0), _droppedBytes(0) {}
+
+void GpsStreamDemux::reset() {
+  _length = 0;
+  _scanPos = 0;
+}
+
+void GpsStreamDemux::compact() {
+  if (_scanPos == 0) {
+    return;
+  }
+  size_t remaining = _length - _scanPos;
+  if (remaining > 0) {
+    memmove(_buffer, _buffer + _scanPos, remaining);
+  }
+  _length = remaining;
+  _scanPos = 0;
+}
+
+size_t GpsStreamDemux::fill(Stream &serial) {
+  // 先把已消费的部分腾出来，保证半帧总是从缓冲区头部开始，
+  // 后续 nextFrame() 返回的切片才能保持连续。
+  compact();
+
+  size_t readCount = 0;
+  int avail = serial.available();
+  while (avail > 0 && _length < BUFFER_SIZE) {
+    int c = serial.read();
+    if (c < 0) {
+      break;
+    }
+    _buffer[_length++] = (uint8_t)c;
+    readCount++;
+    avail--;
+  }
+  return readCount;
+}
+
+size_t GpsStreamDemux::fill(const uint8_t *data, size_t length) {
+  compact();
+
+  size_t space = BUFFER_SIZE - _length;
+  size_t toCopy = (length <= space) ? length : space;
+  if (toCopy > 0) {
+    memcpy(_buffer + _length, data, toCopy);
+    _length += toCopy;
+  }
+  if (toCopy < length) {
+    _droppedBytes += length - toCopy;
+  }
+  return toCopy;
+}
+
+bool GpsStreamDemux::nextFrame(GpsFrame &frame) {
+  while (_scanPos < _length) {
+    uint8_t first = _buffer[_scanPos];
+
+    if (first == '$') {
+      // NMEA 语句：扫描到'\n'为止
+      size_t end = _scanPos + 1;
+      while (end < _length && _buffer[end] != '\n') {
+        end++;
+      }
+      if (end < _length) {
+        frame.type = GpsFrameType::NMEA;
+        frame.data = _buffer + _scanPos;
+        frame.length = end - _scanPos + 1; // 包含'\n'
+        _scanPos = end + 1;
+        return true;
+      }
+      // 没有找到结束符：语句超长说明失去同步，丢弃重新找帧头
+      if (_length - _scanPos > NMEA_MAX_SENTENCE) {
+        _droppedBytes += _length - _scanPos;
+        _scanPos = _length;
+        compact();
+        return false;
+      }
+      // 半帧，等待更多数据
+      compact();
+      return false;
+    }
+
+    if (first == 0xBA) {
+      size_t avail = _length - _scanPos;
+      if (avail < 2) {
+        compact();
+        return false; // 等待第二个帧头字节
+      }
+      if (_buffer[_scanPos + 1] != 0xCE) {
+        // 不是 CASIC 帧头，0xBA 按噪声丢弃
+        _droppedBytes++;
+        _scanPos++;
+        continue;
+      }
+      if (avail < 4) {
+        compact();
+        return false; // 等待长度字段
+      }
+      uint16_t payloadLen =
+          _buffer[_scanPos + 2] | ((uint16_t)_buffer[_scanPos + 3] << 8);
+      size_t frameLen = CASIC_OVERHEAD + payloadLen;
+      if (frameLen > CASIC_MAX_FRAME) {
+        // 长度非法，跳过帧头重新同步
+        _droppedBytes += 2;
+        _scanPos += 2;
+        continue;
+      }
+      if (avail < frameLen) {
+        compact();
+        return false; // 半帧，等待更多数据
+      }
+      frame.type = GpsFrameType::CASIC;
+      frame.data = _buffer + _scanPos;
+      frame.length = frameLen;
+      _scanPos += frameLen;
+      return true;
+    }
+
+    // 帧头之外的字节（帧间的\r\n 或线路噪声），丢弃
+    if (first != '\r' && first != '\n') {
+      _droppedBytes++;
+    }
+    _scanPos++;
+  }
+
+  compact();
+  return false;
+}
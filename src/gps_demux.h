@@ -0,0 +1,68 @@
+#ifndef GPS_DEMUX_H
+#define GPS_DEMUX_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// GPS 串口数据流分离器
+//
+// 将 GPS_SERIAL 上混合的 NMEA ($...\r\n) 和 CASIC (BA CE ...) 数据流
+// 按帧切分。字节先批量读入内部缓冲区，之后以完整帧为单位（缓冲区内的
+// 连续切片，不做拷贝）交给各自的解析器，避免逐字节的函数调用开销。
+
+// 帧类型
+enum class GpsFrameType : uint8_t {
+  NMEA, // 以'$'开始、以'\n'结束的 NMEA 语句
+  CASIC // BA CE [len:2] [class] [id] [payload] [cksum:4] 二进制帧
+};
+
+// 一个完整帧的描述。data 指向分离器内部缓冲区，
+// 仅在下一次 fill()/nextFrame() 调用前有效。
+struct GpsFrame {
+  GpsFrameType type;
+  const uint8_t *data;
+  size_t length;
+};
+
+class GpsStreamDemux {
+public:
+  GpsStreamDemux();
+
+  // 批量读取串口 FIFO 中当前可用的字节到内部缓冲区。
+  // 返回本次读入的字节数。
+  size_t fill(Stream &serial);
+
+  // 从外部缓冲区（如 GpsRxPump 交换出的缓冲区）批量灌入数据。
+  // 返回实际接收的字节数，装不下的部分丢弃并计入 droppedBytes。
+  size_t fill(const uint8_t *data, size_t length);
+
+  // 扫描缓冲区，取出下一个完整帧。
+  // 返回 true 并填充 frame；没有完整帧时返回 false。
+  // 返回 false 时会把未完成的半帧搬移到缓冲区头部，等待后续数据。
+  bool nextFrame(GpsFrame &frame);
+
+  // 丢弃所有缓冲数据（GPS 断电时调用，避免残留半帧）。
+  void reset();
+
+  // 因缓冲区溢出/同步失败被丢弃的字节数（调试统计用）
+  uint32_t droppedBytes() const { return _droppedBytes; }
+
+private:
+  // 要装得下 GpsRxPump 一次交换出的整个缓冲区外加半帧残留
+  static const size_t BUFFER_SIZE = 2560;
+  // CASIC 帧固定开销: BA CE + len(2) + class + id + checksum(4)
+  static const size_t CASIC_OVERHEAD = 10;
+  static const size_t CASIC_MAX_FRAME = CASIC_OVERHEAD + 256;
+  static const size_t NMEA_MAX_SENTENCE = 100;
+
+  uint8_t _buffer[BUFFER_SIZE];
+  size_t _length;   // 缓冲区内有效字节数
+  size_t _scanPos;  // 已消费（帧已取出）的位置
+  uint32_t _droppedBytes;
+
+  // 把 [_scanPos, _length) 的剩余数据搬到缓冲区头部
+  void compact();
+};
+
+#endif // GPS_DEMUX_H
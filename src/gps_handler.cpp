@@ -1,16 +1,30 @@
 #include "gps_handler.h"
+#include "agnss_ring.h"        // Fixed arena ring for streaming A-GNSS
+#include "casic_frame.h"       // CASIC 帧构建（AID-INI 种子）
 #include "casic_gps_wrapper.h" // For CASIC protocol support
 #include "config.h"
+#include "gps_demux.h" // Frame demultiplexer for the GPS serial stream
+#include "gps_rx_pump.h" // Double-buffered UART RX pump
 #include "gpx_logger.h"  // For appendGpxPoint
+#include "altitude_fusion.h" // 气压/GPS 海拔融合
+#include "accel_analyzer.h"  // 动态评分用加速度方差
+#include "state_journal.h" // 状态/AGNSS 新鲜度持久化
 #include "logger.h"      // For Log
 #include "system_info.h" // For gSystemInfo and GpsState_t
 #include <Arduino.h>
 #include <stdint.h> // For uint32_t, int32_t
-#include <vector>   // For AGNSS message queue
 
 // --- State Machine Constants (as per state_spec.md, kept internal to
 // gps_handler.cpp) ---
-static const unsigned long T_ACTIVE_SAMPLING_INTERVAL = 1 * 1000UL; // 1 seconds
+// S3 采样间隔按运动动态自适应（见 adaptiveSamplingIntervalMs）：
+// 转弯/加减速时 1-2 s 保形状，匀速直线拉长到 30 s 省 GPS 功耗，
+// 变化的间隔由编码器的差分压缩吸收
+static const unsigned long T_ADAPTIVE_SAMPLING_MIN = 1 * 1000UL;
+static const unsigned long T_ADAPTIVE_SAMPLING_MAX = 30 * 1000UL;
+// 动态评分的归一化基准：任一项到达基准值即给满分（间隔压到最小）
+static const float DYN_SPEED_DELTA_REF_KMPH = 10.0f; // 速度变化
+static const float DYN_COURSE_DELTA_REF_DEG = 25.0f; // 航向变化
+static const float DYN_ACCEL_VARIANCE_REF = 0.05f;   // 加速度方差 (g^2)
 // ACCEL_STILL_THRESHOLD is used by accel_handler, gSystemInfo.isStationary
 // reflects its outcome
 static const unsigned long T_STILLNESS_CONFIRM_DURATION =
@@ -23,17 +37,40 @@ static const unsigned long T_GPS_COLD_START_FIX_TIMEOUT =
     90 * 1000UL; // 90 seconds
 static const unsigned long T_GPS_REACQUIRE_FIX_TIMEOUT =
     30 * 1000UL; // 30 seconds
+// 热启动模型的中间档：星历过期但历书还在（见 computeStartClass）
+static const unsigned long T_GPS_WARM_START_FIX_TIMEOUT = 60 * 1000UL;
+// 星历/历书/A-GNSS 注入数据的有效期（秒）
+static const uint32_t HOTSTART_EPH_VALID_S = 2 * 3600UL;
+static const uint32_t HOTSTART_AGNSS_VALID_S = 4 * 3600UL;
+static const uint32_t HOTSTART_ALMANAC_VALID_S = 3 * 24 * 3600UL;
 static const unsigned long T_GPS_SLEEP_PERIODIC_WAKE_INTERVAL =
     15 * 60 * 1000UL; // 15 minutes
 // AGNSS related constants
-static const unsigned long T_AGNSS_MESSAGE_SEND_TIMEOUT = 1;     // 1 seconds
+static const unsigned long T_AGNSS_INFLIGHT_TIMEOUT_MS = 1500; // 单条 ACK 超时
 static const unsigned long T_AGNSS_TOTAL_TIMEOUT = 60 * 10000UL; // 60 seconds
 static const uint8_t MAX_AGNSS_MESSAGE_RETRY = 3;                // 3 retries
-static std::vector<std::vector<uint8_t>> AGNSS_Message_Queue;
+// 窗口化注入：最多 AGNSS_WINDOW_SIZE 条消息同时在途。模块能缓冲
+// 多条 AID 消息，逐条等 ACK 是纯串行浪费；ACK/NACK 按 class/id
+// 匹配最老的在途条目结算，只有被 NACK 或超时的条目才重传
+#define AGNSS_WINDOW_SIZE 4
+struct AgnssInflight {
+  bool used;
+  uint8_t cls;
+  uint8_t id;
+  uint16_t len;
+  uint8_t retries;
+  uint32_t seq;          // 入窗顺序（同 class/id 多条在途时匹配最老的）
+  unsigned long sentMs;
+  uint8_t frame[AGNSS_MAX_MESSAGE_SIZE]; // 重传需要自己持有字节
+};
+static AgnssInflight agnssWindow[AGNSS_WINDOW_SIZE];
+static uint32_t agnssWindowSeq = 0;
 
 // --- GPS objects and internal state variables ---
 CasicGpsWrapper gpsWrapper; // CASIC GPS wrapper that includes TinyGPS++
 HardwareSerial &gpsSerial = GPS_SERIAL; // Use definition from config.h
+static GpsStreamDemux gpsDemux; // 按帧切分串口数据，再整帧交给解析器
+static GpsRxPump gpsRxPump; // 定时器任务侧抽取串口数据，与 loop 阻塞解耦
 
 // Structure to hold position data, similar to the old one but might not be
 // strictly needed if gSystemInfo is always up-to-date before logging.
@@ -43,6 +80,10 @@ struct PositionResult {
   double longitude{0};
   double altitude_m{0};
   double hdop{1e9};
+  // 定点视图（日志热路径用，不做 double 运算）
+  int32_t latitude_scaled_1e7{0};
+  int32_t longitude_scaled_1e7{0};
+  int32_t altitude_cm{0};
 };
 static PositionResult last_successful_position =
     PositionResult{}; // Still useful for logging the *last good* fix
@@ -99,17 +140,120 @@ public:
 
 static SpeedAverage speedAverage;
 // AGNSS related variables
-static unsigned long AGNSS_Message_Timer_Start = 0;
 static unsigned long AGNSS_Total_Timer_Start = 0;
 static bool AGNSS_Request_Pending = true; // Flag to indicate AGNSS request
-static size_t AGNSS_Current_Message_Index = 0;
-static uint8_t AGNSS_Current_Message_Retry_Count = 0;
 static GpsState_t AGNSS_Previous_State = S2_IDLE_GPS_OFF;
 // Tracks if the *very first* fix attempt (cold start) has been tried since init
 // or a long sleep. This helps decide T_GPS_COLD_START_FIX_TIMEOUT vs
 // T_GPS_REACQUIRE_FIX_TIMEOUT.
 static bool isFirstFixAttemptCycle = true;
 
+// --- 热启动模型 ---
+// 持久化的最后一次定位（JOURNAL_LAST_FIX，16 字节正好占满记录载荷）
+#pragma pack(push, 1)
+struct LastFixRecord {
+  uint32_t timestamp; // Unix 秒
+  int32_t lat_1e7;
+  int32_t lon_1e7;
+  int32_t alt_cm;
+};
+#pragma pack(pop)
+
+static LastFixRecord journaledFix = {0, 0, 0, 0};
+static uint32_t journaledAgnssTs = 0; // 最后一次 A-GNSS 注入的时刻
+static bool clockTrustedThisBoot = false; // 本次上电后拿到过 GPS 时间
+
+// 本地 Unix 时间估计的锚点：有 GPS 时间时持续刷新；重启后先用
+// 日志里的最后定位时刻垫底（只是真实时间的下界）
+static uint32_t estUnixBase = 0;
+static unsigned long estMsBase = 0;
+
+// 本轮 S1 的定位超时（prepareFixAttempt 按启动等级设置；
+// 0 = 沿用旧的冷启动/再捕获二选一）
+static unsigned long Current_Fix_Timeout = 0;
+static bool aidSeedPending = false; // 上电后待发送 AID-INI 种子
+
+enum GpsStartClass { GPS_START_COLD = 0, GPS_START_WARM, GPS_START_HOT };
+
+static uint32_t estimatedUnixNow() {
+  if (estUnixBase == 0) {
+    return 0;
+  }
+  return estUnixBase + (uint32_t)((millis() - estMsBase) / 1000);
+}
+
+// 按星历/历书/A-GNSS 新鲜度推断预期的定位耗时等级
+static GpsStartClass computeStartClass() {
+  uint32_t nowTs = estimatedUnixNow();
+  if (nowTs == 0) {
+    return GPS_START_COLD;
+  }
+  uint32_t fixAge = (journaledFix.timestamp != 0 &&
+                     nowTs >= journaledFix.timestamp)
+                        ? nowTs - journaledFix.timestamp
+                        : UINT32_MAX;
+  uint32_t agnssAge =
+      (journaledAgnssTs != 0 && nowTs >= journaledAgnssTs)
+          ? nowTs - journaledAgnssTs
+          : UINT32_MAX;
+
+  GpsStartClass cls = GPS_START_COLD;
+  if (fixAge <= HOTSTART_ALMANAC_VALID_S) {
+    cls = GPS_START_WARM;
+  }
+  if (fixAge <= HOTSTART_EPH_VALID_S || agnssAge <= HOTSTART_AGNSS_VALID_S) {
+    cls = GPS_START_HOT;
+  }
+  // 重启后还没拿到真实时间：本地时钟只是下界，年龄被低估，
+  // 最乐观也只按 WARM 处理
+  if (cls == GPS_START_HOT && !clockTrustedThisBoot) {
+    cls = GPS_START_WARM;
+  }
+  return cls;
+}
+
+// --- S3 自适应采样 ---
+extern AccelAnalyzer accelAnalyzer; // 实例在 main.cpp，喂样由 accel 任务做
+
+// 上一个已落盘采样点的速度/航向基准（动态评分的参照）
+static float lastSampleSpeedKmph = 0.0f;
+static float lastSampleCourseDeg = 0.0f;
+static bool sampleBaselineValid = false;
+
+// 由当前动态算出 S3 采样间隔：三路归一化评分取和（加速度方差、
+// 速度变化、航向变化），评分 0 → 最大间隔，≥1 → 最小间隔。
+// 每趟循环都重新评估，转弯发生在间隔中途也会立刻缩短等待。
+static unsigned long adaptiveSamplingIntervalMs() {
+  float score = accelAnalyzer.variance() / DYN_ACCEL_VARIANCE_REF;
+
+  if (sampleBaselineValid && gSystemInfo.locationValid) {
+    float dSpeed = gSystemInfo.speed - lastSampleSpeedKmph;
+    if (dSpeed < 0) {
+      dSpeed = -dSpeed;
+    }
+    score += dSpeed / DYN_SPEED_DELTA_REF_KMPH;
+
+    // 低速时 NMEA 航向是噪声，只在车速以上才计入转弯评分
+    if (gSystemInfo.speed > GPS_SPEED_VEHICLE_THRESHOLD) {
+      float dCourse = gSystemInfo.course - lastSampleCourseDeg;
+      if (dCourse < 0) {
+        dCourse = -dCourse;
+      }
+      if (dCourse > 180.0f) {
+        dCourse = 360.0f - dCourse;
+      }
+      score += dCourse / DYN_COURSE_DELTA_REF_DEG;
+    }
+  }
+
+  if (score > 1.0f) {
+    score = 1.0f;
+  }
+  return T_ADAPTIVE_SAMPLING_MAX -
+         (unsigned long)((T_ADAPTIVE_SAMPLING_MAX - T_ADAPTIVE_SAMPLING_MIN) *
+                         score);
+}
+
 // --- Helper Function to reset all timers (used when changing states often) ---
 static void resetAllStateTimers() {
   Stillness_Confirm_Timer_Start = 0;
@@ -117,7 +261,6 @@ static void resetAllStateTimers() {
   Fix_Attempt_Timer_Start = 0;
   Periodic_Wake_Timer_Start = 0;
   GPS_Query_Timeout_Timer_S4_Start = 0;
-  AGNSS_Message_Timer_Start = 0;
   AGNSS_Total_Timer_Start = 0;
 }
 
@@ -134,8 +277,100 @@ void powerOnGPS() {
 #endif
 }
 
+// 关机前把最后一次定位写进日志（journalWrite 对相同内容去重，
+// 没有新定位时不产生擦写）
+static void journalLastFix() {
+  if (last_successful_position.timestamp == 0) {
+    return;
+  }
+  LastFixRecord rec;
+  rec.timestamp = last_successful_position.timestamp;
+  rec.lat_1e7 = last_successful_position.latitude_scaled_1e7;
+  rec.lon_1e7 = last_successful_position.longitude_scaled_1e7;
+  rec.alt_cm = last_successful_position.altitude_cm;
+  journalWrite(JOURNAL_LAST_FIX, &rec, sizeof(rec));
+  journaledFix = rec; // RAM 里的模型同步跟上
+}
+
+// AID-INI 载荷（CASIC 0x0B 0x01，56 字节，布局见 docs/casic_agnss.md）
+#pragma pack(push, 1)
+struct AidIniPayload {
+  double lat;       // 度
+  double lon;       // 度
+  double alt;       // 米
+  double tow;       // GPS 周内秒
+  float freqBias;   // 时钟频偏，未知填 0
+  float pAcc;       // 位置误差方差，未知填 0
+  float tAcc;       // 时间误差方差
+  float fAcc;       // 频漂误差方差
+  uint32_t res;     // 保留
+  uint16_t wn;      // GPS 周数
+  uint8_t timerSource;
+  uint8_t flags;    // B0 位置有效 B1 时间有效 B5 LLA 格式 B6 海拔无效
+};
+#pragma pack(pop)
+
+// 向模块发送位置+时间种子。L76K 拿到大致位置和时间后可以跳过
+// 搜星的盲扫阶段，热/温启动的定位时间显著缩短
+static void sendAidIniSeed() {
+  if (journaledFix.timestamp == 0) {
+    return;
+  }
+  AidIniPayload p;
+  memset(&p, 0, sizeof(p));
+  p.lat = journaledFix.lat_1e7 / 1e7;
+  p.lon = journaledFix.lon_1e7 / 1e7;
+  p.alt = journaledFix.alt_cm / 100.0;
+  uint8_t flags = 0x01 | 0x20; // 位置有效 + LLA
+
+  uint32_t nowTs = estimatedUnixNow();
+  if (clockTrustedThisBoot && nowTs != 0) {
+    // GPS 时间 = Unix 时间 - GPS 纪元 (1980-01-06) + 闰秒
+    uint32_t gpsSec = nowTs - 315964800UL + 18;
+    p.wn = (uint16_t)(gpsSec / 604800UL);
+    p.tow = (double)(gpsSec % 604800UL);
+    flags |= 0x02; // 时间有效
+  }
+  p.flags = flags;
+
+  uint8_t frame[10 + sizeof(AidIniPayload)];
+  uint16_t n =
+      casic::buildFrame(CASIC_CLASS_AID, CASIC_ID_AID_INI,
+                        (const uint8_t *)&p, sizeof(p), frame, sizeof(frame));
+  if (n != 0) {
+    gpsSerial.write(frame, n);
+    Log.printf("AID-INI 种子已发送（时间%s）\n",
+               (flags & 0x02) ? "有效" : "未知");
+  }
+}
+
+// 进入 S1 前按启动等级选择定位超时和是否发种子。
+// 冷启动时顺带重发精简 NMEA 输出配置——模块长时间断电后可能
+// 回到默认的全语句输出
+static void prepareFixAttempt() {
+  GpsStartClass cls = computeStartClass();
+  switch (cls) {
+  case GPS_START_HOT:
+    Current_Fix_Timeout = T_GPS_REACQUIRE_FIX_TIMEOUT;
+    break;
+  case GPS_START_WARM:
+    Current_Fix_Timeout = T_GPS_WARM_START_FIX_TIMEOUT;
+    break;
+  default:
+    Current_Fix_Timeout = T_GPS_COLD_START_FIX_TIMEOUT;
+    break;
+  }
+  aidSeedPending = (cls != GPS_START_COLD) && journaledFix.timestamp != 0;
+  if (cls == GPS_START_COLD) {
+    gpsSerial.println("$PCAS03,1,0,0,0,1,0,0,0,0,0,,,0,0*02"); // GGA + RMC
+  }
+  Log.printf("S1 准备：启动等级 %d，超时 %lu ms，种子待发 %d\n", (int)cls,
+             Current_Fix_Timeout, (int)aidSeedPending);
+}
+
 // --- Function to explicitly power off the GPS module ---
 void powerOffGPS() {
+  journalLastFix();
 #ifdef PIN_GPS_EN
   pinMode(PIN_GPS_EN, OUTPUT);
   digitalWrite(PIN_GPS_EN, LOW); // Assuming LOW turns GPS OFF
@@ -146,6 +381,8 @@ void powerOffGPS() {
 #endif
   // Reset GPS data when turning off to avoid showing stale data
   gpsWrapper.reset(); // Clears internal TinyGPS++ state and CASIC parser
+  gpsDemux.reset();   // Drop any buffered half-frame from the serial stream
+  gpsRxPump.flush();  // Drop data still sitting in the RX swap buffers
   // Explicitly clear relevant gSystemInfo fields related to current fix
   gSystemInfo.locationValid = false;
   gSystemInfo.dateTimeValid = false;
@@ -165,43 +402,139 @@ void powerOffGPS() {
 }
 
 // --- AGNSS related helper functions ---
+static void agnssWindowReset() {
+  for (uint8_t i = 0; i < AGNSS_WINDOW_SIZE; i++) {
+    agnssWindow[i].used = false;
+  }
+  agnssWindowSeq = 0;
+}
+
 static void initAgnssVariables() {
-  AGNSS_Current_Message_Index = 0;
-  AGNSS_Current_Message_Retry_Count = 0;
-  AGNSS_Message_Timer_Start = 0;
   AGNSS_Total_Timer_Start = 0;
+  agnssWindowReset();
+}
+
+static bool agnssWindowEmpty() {
+  for (uint8_t i = 0; i < AGNSS_WINDOW_SIZE; i++) {
+    if (agnssWindow[i].used) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// 发送（或重发）一个在途条目
+static void agnssTransmitSlot(AgnssInflight &slot, unsigned long now) {
+  size_t sent = gpsSerial.write(slot.frame, slot.len);
+  slot.sentMs = now;
+  if (sent != slot.len) {
+    Log.printf("AGNSS: 条目 %lu 串口只写出 %d/%d 字节\n",
+               (unsigned long)slot.seq, (int)sent, (int)slot.len);
+  } else {
+    Log.printf("AGNSS: 注入 0x%02X 0x%02X (#%lu, %d 字节, 第 %d 次)\n",
+               slot.cls, slot.id, (unsigned long)slot.seq, (int)slot.len,
+               slot.retries + 1);
+  }
+}
+
+// 补窗：只要有空位且环里有消息，就出队装进在途表并立即注入。
+// 多条消息在 UART 上背靠背发出，ACK 异步回来逐条结算
+static void agnssFillWindow(unsigned long now) {
+  for (uint8_t i = 0; i < AGNSS_WINDOW_SIZE; i++) {
+    AgnssInflight &slot = agnssWindow[i];
+    if (slot.used) {
+      continue;
+    }
+    uint16_t msgLen = agnssRing.peek(slot.frame, sizeof(slot.frame));
+    if (msgLen == 0) {
+      return; // 环空
+    }
+    agnssRing.pop();
+    slot.used = true;
+    slot.len = msgLen;
+    // CASIC 帧：BA CE len_lo len_hi cls id ...
+    slot.cls = (msgLen > 5) ? slot.frame[4] : 0;
+    slot.id = (msgLen > 5) ? slot.frame[5] : 0;
+    slot.retries = 0;
+    slot.seq = agnssWindowSeq++;
+    agnssTransmitSlot(slot, now);
+  }
+}
+
+// ACK/NACK 结算：按 class/id 匹配最老的在途条目。
+// ACK 释放槽位；NACK 立即重传，超过重试上限的条目放弃（跳过比
+// 卡死整个注入好，模块缺一条星历只是少一颗卫星的辅助）
+static void agnssSettleAck(uint8_t cls, uint8_t id, bool isAck,
+                           unsigned long now) {
+  int match = -1;
+  for (uint8_t i = 0; i < AGNSS_WINDOW_SIZE; i++) {
+    AgnssInflight &slot = agnssWindow[i];
+    if (slot.used && slot.cls == cls && slot.id == id &&
+        (match < 0 || slot.seq < agnssWindow[match].seq)) {
+      match = i;
+    }
+  }
+  if (match < 0) {
+    // 可能是 AID-INI 种子或迟到的重复 ACK，与在途表无关
+    Log.printf("AGNSS: 收到无匹配的 %s (0x%02X 0x%02X)\n",
+               isAck ? "ACK" : "NACK", cls, id);
+    return;
+  }
+  AgnssInflight &slot = agnssWindow[match];
+  if (isAck) {
+    slot.used = false;
+    return;
+  }
+  slot.retries++;
+  if (slot.retries >= MAX_AGNSS_MESSAGE_RETRY) {
+    Log.printf("AGNSS: 条目 #%lu 连续 NACK，放弃\n", (unsigned long)slot.seq);
+    slot.used = false;
+  } else {
+    agnssTransmitSlot(slot, now);
+  }
 }
 
-static void sendCurrentAgnssMessage() {
-  if (AGNSS_Current_Message_Index < AGNSS_Message_Queue.size()) {
-    const auto &message = AGNSS_Message_Queue[AGNSS_Current_Message_Index];
-    auto len = gpsSerial.write(message.data(), message.size());
-    if (len != message.size()) {
-      Log.printf(
-          "AGNSS: Failed to send message %d, expected %d bytes, sent %d\n",
-          (int)AGNSS_Current_Message_Index, (int)message.size(), (int)len);
-      AGNSS_Current_Message_Retry_Count++;
+// 超时扫描：到期未结算的条目重传，超过重试上限放弃
+static void agnssRetryTimedOut(unsigned long now) {
+  for (uint8_t i = 0; i < AGNSS_WINDOW_SIZE; i++) {
+    AgnssInflight &slot = agnssWindow[i];
+    if (!slot.used || now - slot.sentMs < T_AGNSS_INFLIGHT_TIMEOUT_MS) {
+      continue;
+    }
+    slot.retries++;
+    if (slot.retries >= MAX_AGNSS_MESSAGE_RETRY) {
+      Log.printf("AGNSS: 条目 #%lu ACK 超时次数用尽，放弃\n",
+                 (unsigned long)slot.seq);
+      slot.used = false;
     } else {
-      Log.printf("AGNSS: Successfully sent message %d, size %d bytes\n",
-                 (int)AGNSS_Current_Message_Index, (int)len);
+      Log.printf("AGNSS: 条目 #%lu ACK 超时，重传 (%d/%d)\n",
+                 (unsigned long)slot.seq, slot.retries + 1,
+                 MAX_AGNSS_MESSAGE_RETRY);
+      agnssTransmitSlot(slot, now);
     }
-    Log.printf("AGNSS: Sent message %d/%d (retry %d)\n",
-               (int)(AGNSS_Current_Message_Index + 1),
-               (int)AGNSS_Message_Queue.size(),
-               AGNSS_Current_Message_Retry_Count);
   }
 }
 
 // Helper function to check if AGNSS should be triggered
 static bool shouldTriggerAgnss() {
   return millis() > 10 * 1000 && AGNSS_Request_Pending &&
-         !AGNSS_Message_Queue.empty() &&
-         gSystemInfo.gpsState != S5_AGNSS_PROCESSING;
+         !agnssRing.empty() && gSystemInfo.gpsState != S5_AGNSS_PROCESSING;
+}
+
+// AGNSS 注入成功后记下新鲜度时间戳，重启后可据此判断星历是否还可用
+static void journalAgnssFreshness() {
+  if (gSystemInfo.dateTimeValid) {
+    uint32_t ts = dateTimeToUnixTimestamp(
+        gSystemInfo.year, gSystemInfo.month, gSystemInfo.day, gSystemInfo.hour,
+        gSystemInfo.minute, gSystemInfo.second);
+    journalWrite(JOURNAL_AGNSS_FRESHNESS, &ts, sizeof(ts));
+    journaledAgnssTs = ts; // 热启动模型的 RAM 副本同步跟上
+  }
 }
 
 static void transitionBackFromAgnss(unsigned long now) {
   // Clean up AGNSS state
-  AGNSS_Message_Queue.clear();
+  agnssRing.reset();
   initAgnssVariables();
 
   // Transition back based on previous state
@@ -237,19 +570,17 @@ static void transitionBackFromAgnss(unsigned long now) {
   }
 }
 
-// --- Public function to set AGNSS message queue ---
-void setAgnssMessageQueue(const std::vector<std::vector<uint8_t>> &messages) {
-  AGNSS_Message_Queue = messages;
-  if (!messages.empty()) {
+// --- Public function to flag streamed AGNSS data availability ---
+// BLE 侧收到第一块就调用：状态机无需等 END，注入与接收并行
+void notifyAgnssStreamActive() {
+  if (!agnssRing.empty()) {
     AGNSS_Request_Pending = true;
-    Log.printf("AGNSS: Message queue set with %d messages, request pending\n",
-               (int)messages.size());
   }
 }
 
 // --- Public function to trigger AGNSS processing ---
 void triggerAgnssProcessing() {
-  if (AGNSS_Message_Queue.empty()) {
+  if (agnssRing.empty()) {
     Log.println("AGNSS: No messages in queue, ignoring trigger");
     return;
   }
@@ -278,9 +609,8 @@ void triggerAgnssProcessing() {
   initAgnssVariables();
   AGNSS_Total_Timer_Start = now;
 
-  // Send first message
-  sendCurrentAgnssMessage();
-  AGNSS_Message_Timer_Start = now;
+  // 立即把窗口填满，首批消息背靠背注入
+  agnssFillWindow(now);
 
   gSystemInfo.gpsState = S5_AGNSS_PROCESSING;
   Log.printf("GPS State: %d -> S5_AGNSS_PROCESSING (AGNSS triggered)\n",
@@ -296,6 +626,7 @@ void triggerGpsWakeup() {
   // 如果当前在 S2_IDLE_GPS_OFF 状态，直接触发状态转换
   if (gSystemInfo.gpsState == S2_IDLE_GPS_OFF) {
     Log.println("GPS State: S2 -> S1_GPS_SEARCHING_FIX (手动唤醒)");
+    prepareFixAttempt();
     powerOnGPS();
     resetAllStateTimers();
     Fix_Attempt_Timer_Start = millis();
@@ -339,12 +670,27 @@ void initGPS() {
   }
   Log.println("GPS Serial Initialized, NMEA configured.");
 
+  // 启动接收泵：之后串口数据由定时器任务抽取，SD 写入阻塞 loop
+  // 时不再丢 NMEA 数据
+  gpsRxPump.begin(gpsSerial);
+
 #ifdef PIN_GPS_EN
   pinMode(PIN_GPS_EN, OUTPUT);
 #endif
 
   // E0.1_Initialization_Complete: Default to power-saving start ->
   // S2_IDLE_GPS_OFF
+  // 恢复热启动模型：上次定位和 A-GNSS 注入时刻都在 littlefs 日志里
+  if (journalRead(JOURNAL_LAST_FIX, &journaledFix, sizeof(journaledFix))) {
+    Log.printf("热启动模型：日志里有 %lu 时刻的定位\n",
+               (unsigned long)journaledFix.timestamp);
+    // 重启后先拿最后定位时刻当本地时钟下界（真实流逝时间未知）
+    estUnixBase = journaledFix.timestamp;
+    estMsBase = millis();
+  }
+  journalRead(JOURNAL_AGNSS_FRESHNESS, &journaledAgnssTs,
+              sizeof(journaledAgnssTs));
+
   powerOffGPS();
   resetAllStateTimers();
   Periodic_Wake_Timer_Start = millis(); // Start periodic wake timer
@@ -381,12 +727,28 @@ void updateGpsSystemInfo() {
   gSystemInfo.dateTimeValid = dateTimeValid;
 
   if (gSystemInfo.locationValid) {
-    gSystemInfo.latitude = gps.location.lat();
-    gSystemInfo.longitude = gps.location.lng();
+    // 定点快速路径：TinyGPS++ 的 RawDegrees 已经在整数域完成了
+    // ddmm.mmmm -> 度 的换算（deg + 十亿分之一度），这里纯整数缩放
+    // 到 1e7，全程不碰 double（M4F 上 double 是软浮点）
+    const RawDegrees &rawLat = gps.location.rawLat();
+    const RawDegrees &rawLng = gps.location.rawLng();
+    int32_t lat1e7 = (int32_t)rawLat.deg * 10000000L +
+                     (int32_t)((rawLat.billionths + 50UL) / 100UL);
+    int32_t lng1e7 = (int32_t)rawLng.deg * 10000000L +
+                     (int32_t)((rawLng.billionths + 50UL) / 100UL);
+    gSystemInfo.latitude_scaled_1e7 = rawLat.negative ? -lat1e7 : lat1e7;
+    gSystemInfo.longitude_scaled_1e7 = rawLng.negative ? -lng1e7 : lng1e7;
+    gSystemInfo.altitude_cm = gps.altitude.value(); // TinyGPS++ 原生厘米整数
+    // 显示用视图由整数换算（单精度乘法，硬件 FPU 一条指令）
+    gSystemInfo.latitude = gSystemInfo.latitude_scaled_1e7 * 1e-7f;
+    gSystemInfo.longitude = gSystemInfo.longitude_scaled_1e7 * 1e-7f;
     gSystemInfo.satellites = gps.satellites.value();
-    gSystemInfo.altitude = gps.altitude.meters();
+    gSystemInfo.altitude = gSystemInfo.altitude_cm * 0.01f;
   } else {
     // Keep old values or reset? Spec implies reset if invalid.
+    gSystemInfo.latitude_scaled_1e7 = 0;
+    gSystemInfo.longitude_scaled_1e7 = 0;
+    gSystemInfo.altitude_cm = 0;
     gSystemInfo.latitude = 0.0;
     gSystemInfo.longitude = 0.0;
     gSystemInfo.satellites =
@@ -431,6 +793,10 @@ void updateGpsSystemInfo() {
     gSystemInfo.minute = 0;
     gSystemInfo.second = 0;
   }
+
+  // 一批相关字段写完，发布一致快照（lat/lon/时间戳从此不会被
+  // 别的上下文读到半对）
+  publishSystemInfo();
 }
 
 // --- Helper function to convert GPS date/time to an approximate Unix timestamp
@@ -461,11 +827,41 @@ uint32_t dateTimeToUnixTimestamp(uint16_t year, uint8_t month, uint8_t day,
 // gSystemInfo ---
 void handleGPS() {
   unsigned long now = millis();
+
+  // 有 GPS 时间时每秒校准一次本地 Unix 时钟锚点（热启动模型用）
+  static unsigned long lastClockSyncMs = 0;
+  if (gSystemInfo.dateTimeValid && now - lastClockSyncMs >= 1000) {
+    estUnixBase = dateTimeToUnixTimestamp(
+        gSystemInfo.year, gSystemInfo.month, gSystemInfo.day, gSystemInfo.hour,
+        gSystemInfo.minute, gSystemInfo.second);
+    estMsBase = now;
+    clockTrustedThisBoot = true;
+    lastClockSyncMs = now;
+  }
+
   if (isGpsPoweredOn) {
-    while (gpsSerial.available() > 0) {
-      char byte = gpsSerial.read();
-      // Log.print(byte);
-      if (gpsWrapper.encode(byte)) {
+    // 取出接收泵已填满的交换缓冲区，按完整帧消费。整句/整包连续
+    // 喂给解析器，避免在 NMEA 与 CASIC 间逐字节判别的开销。
+    const uint8_t *rxData = nullptr;
+    size_t rxLength = gpsRxPump.acquire(&rxData);
+    if (rxLength > 0) {
+      gpsDemux.fill(rxData, rxLength);
+    }
+    GpsFrame gpsFrame;
+    while (gpsDemux.nextFrame(gpsFrame)) {
+      bool frameParsed = false;
+      if (gpsFrame.type == GpsFrameType::CASIC) {
+        // 解复用器给的是完整帧，走批量路径（单遍拷贝+增量校验和）
+        frameParsed = gpsWrapper.processBuffer(gpsFrame.data, gpsFrame.length);
+      } else {
+        // NMEA仍逐字节喂给TinyGPS++（其解析器是字节驱动的）
+        for (size_t i = 0; i < gpsFrame.length; i++) {
+          if (gpsWrapper.encode(gpsFrame.data[i])) {
+            frameParsed = true;
+          }
+        }
+      }
+      if (frameParsed) {
         updateGpsSystemInfo();
 
         // 检查是否有新的CASIC数据
@@ -519,6 +915,8 @@ void handleGPS() {
       resetAllStateTimers();
       Active_Sampling_Timer_Start = now;
       Consecutive_Fix_Failures_Counter = 0;
+      Current_Fix_Timeout = 0; // 本轮热启动超时用完即弃
+      aidSeedPending = false;
       isFirstFixAttemptCycle =
           false; // A fix was successful, subsequent ones are reacquires until
                  // next long sleep/init
@@ -530,15 +928,27 @@ void handleGPS() {
       last_successful_position.longitude = gSystemInfo.longitude;
       last_successful_position.altitude_m = gSystemInfo.altitude;
       last_successful_position.hdop = gSystemInfo.hdop;
+      last_successful_position.latitude_scaled_1e7 =
+          gSystemInfo.latitude_scaled_1e7;
+      last_successful_position.longitude_scaled_1e7 =
+          gSystemInfo.longitude_scaled_1e7;
+      last_successful_position.altitude_cm = gSystemInfo.altitude_cm;
 
       gSystemInfo.gpsState = S3_TRACKING_FIXED;
       break; // Exit switch case for this iteration
     }
 
-    // E1.2_Fix_Attempt_Timer_Expired
-    unsigned long current_fix_timeout = isFirstFixAttemptCycle
-                                            ? T_GPS_COLD_START_FIX_TIMEOUT
-                                            : T_GPS_REACQUIRE_FIX_TIMEOUT;
+    // 上电稳定后补发 AID-INI 种子（prepareFixAttempt 里决定是否需要）
+    if (aidSeedPending && now - Fix_Attempt_Timer_Start >= 500) {
+      sendAidIniSeed();
+      aidSeedPending = false;
+    }
+
+    // E1.2_Fix_Attempt_Timer_Expired（热启动模型给出的超时优先）
+    unsigned long current_fix_timeout =
+        (Current_Fix_Timeout != 0) ? Current_Fix_Timeout
+        : (isFirstFixAttemptCycle ? T_GPS_COLD_START_FIX_TIMEOUT
+                                  : T_GPS_REACQUIRE_FIX_TIMEOUT);
     if (now - Fix_Attempt_Timer_Start >= current_fix_timeout) {
       Log.printf("S1: Fix Attempt Timer Expired (%lu ms). Failures: %d\n",
                  current_fix_timeout, Consecutive_Fix_Failures_Counter + 1);
@@ -553,6 +963,8 @@ void handleGPS() {
       resetAllStateTimers();
       Periodic_Wake_Timer_Start = now;
       isFirstFixAttemptCycle = true; // Next attempt after sleep will be cold.
+      Current_Fix_Timeout = 0;
+      aidSeedPending = false;
       gSystemInfo.gpsState = S2_IDLE_GPS_OFF;
       Log.println("GPS State: S1 -> S2_IDLE_GPS_OFF (Fix Timeout)");
       break;
@@ -575,10 +987,15 @@ void handleGPS() {
     if (isGpsPoweredOn)
       powerOffGPS(); // Ensure GPS is OFF
 
+    // GPS 关机期间用标定过的气压海拔续写高程曲线（阈值/节流见
+    // altitude_fusion.cpp，静止时几乎不产生点）
+    serviceAltitudeFusion();
+
     // E2.1_Motion_Detected (gSystemInfo.isStationary is managed by accel
     // handler) If isStationary is false, it means motion is detected.
     if (!gSystemInfo.isStationary) {
       Log.println("GPS State: S2 -> S1_GPS_SEARCHING_FIX (Motion Detected)");
+      prepareFixAttempt();
       powerOnGPS();
       resetAllStateTimers();
       Fix_Attempt_Timer_Start = now;
@@ -591,6 +1008,7 @@ void handleGPS() {
     // E2.2_Periodic_Wake_Timer_Expired
     if (now - Periodic_Wake_Timer_Start >= T_GPS_SLEEP_PERIODIC_WAKE_INTERVAL) {
       Log.println("GPS State: S2 -> S1_GPS_SEARCHING_FIX (Periodic Wake)");
+      prepareFixAttempt();
       powerOnGPS();
       resetAllStateTimers();
       Fix_Attempt_Timer_Start = now;
@@ -626,8 +1044,8 @@ void handleGPS() {
       break;
     }
 
-    // E3.1_Active_Sampling_Timer_Expired
-    if (now - Active_Sampling_Timer_Start >= T_ACTIVE_SAMPLING_INTERVAL) {
+    // E3.1_Active_Sampling_Timer_Expired（间隔随动态实时伸缩）
+    if (now - Active_Sampling_Timer_Start >= adaptiveSamplingIntervalMs()) {
       Log.println("S3: Active Sampling Timer. Logging GPX.");
       // Ensure data is still good before logging (already checked by E3.5, but
       // good practice)
@@ -639,12 +1057,29 @@ void handleGPS() {
         last_successful_position.longitude = gSystemInfo.longitude;
         last_successful_position.altitude_m = gSystemInfo.altitude;
         last_successful_position.hdop = gSystemInfo.hdop;
-
-        appendGpxPoint(last_successful_position.timestamp,
-                       last_successful_position.latitude,
-                       last_successful_position.longitude,
-                       last_successful_position.altitude_m);
+        last_successful_position.latitude_scaled_1e7 =
+            gSystemInfo.latitude_scaled_1e7;
+        last_successful_position.longitude_scaled_1e7 =
+            gSystemInfo.longitude_scaled_1e7;
+        last_successful_position.altitude_cm = gSystemInfo.altitude_cm;
+
+        // S3 采样热路径走定点整数，避免软浮点
+        appendGpxPointFixed(last_successful_position.timestamp,
+                            last_successful_position.latitude_scaled_1e7,
+                            last_successful_position.longitude_scaled_1e7,
+                            last_successful_position.altitude_cm);
         Log.println("GPX Point logged in S3.");
+
+        // 定位期间顺带标定气压海拔偏移（S2/S4 关 GPS 后靠它续高程）
+        altitudeFusionCalibrate(last_successful_position.timestamp,
+                                last_successful_position.latitude_scaled_1e7,
+                                last_successful_position.longitude_scaled_1e7,
+                                last_successful_position.altitude_cm);
+
+        // 刷新动态评分的速度/航向基准
+        lastSampleSpeedKmph = gSystemInfo.speed;
+        lastSampleCourseDeg = gSystemInfo.course;
+        sampleBaselineValid = true;
       }
       Active_Sampling_Timer_Start = now; // Restart timer
     }
@@ -690,6 +1125,9 @@ void handleGPS() {
     if (!isGpsPoweredOn)
       powerOnGPS(); // Ensure GPS is ON for query
 
+    // 静止分析期间 GPS 海拔未必可用（室内/信号差），气压海拔照常续
+    serviceAltitudeFusion();
+
     // E4.1_Motion_Detected_During_Analysis
     if (!gSystemInfo.isStationary) {
       Log.println(
@@ -750,51 +1188,37 @@ void handleGPS() {
     if (!isGpsPoweredOn)
       powerOnGPS(); // Ensure GPS is ON
 
-    // E5.1_AGNSS_ACK_or_NACK_Received (both treated as ACK)
+    // E5.1_AGNSS_ACK_or_NACK_Received：按 class/id 结算在途条目
     if (gpsWrapper.isNewCasicData() &&
         (gpsWrapper.hasNewAck() || gpsWrapper.hasNewNack())) {
-      if (gpsWrapper.hasNewAck()) {
-        Log.println("S5: ACK received for AGNSS message");
+      CasicPacket packet = gpsWrapper.getLastCasicPacket();
+      bool isAck = gpsWrapper.hasNewAck();
+      gpsWrapper.clearCasicData(); // 立即清理数据
+      if (packet.payload_length >= 2) {
+        // ACK/NACK 载荷携带被确认消息的 class/id
+        agnssSettleAck(packet.payload[0], packet.payload[1], isAck, now);
       } else {
-        Log.println("S5: NACK received for AGNSS message (treating as ACK)");
+        Log.println("S5: ACK/NACK 载荷缺 class/id，忽略");
       }
-      gpsWrapper.clearCasicData();   // 立即清理数据
-      AGNSS_Message_Timer_Start = 0; // Stop message timer
-      AGNSS_Current_Message_Index++;
-      AGNSS_Current_Message_Retry_Count = 0;
-
-      if (AGNSS_Current_Message_Index >= AGNSS_Message_Queue.size()) {
-        // All AGNSS messages successfully sent
-        Log.println("S5: All AGNSS messages sent successfully");
-        transitionBackFromAgnss(now);
-      } else {
-        // Send next AGNSS message
-        sendCurrentAgnssMessage();
-        AGNSS_Message_Timer_Start = now;
-      }
-      break;
     }
 
-    // E5.3_AGNSS_Message_Timer_Expired
-    if (AGNSS_Message_Timer_Start != 0 &&
-        now - AGNSS_Message_Timer_Start >= T_AGNSS_MESSAGE_SEND_TIMEOUT) {
-      Log.println("S5: AGNSS message timer expired");
-      AGNSS_Current_Message_Retry_Count++;
+    // 补窗：ACK 释放槽位或 BLE 新块到达后，继续保持窗口满载，
+    // BLE 接收与 UART 注入在时间上重叠
+    agnssFillWindow(now);
 
-      if (AGNSS_Current_Message_Retry_Count >= MAX_AGNSS_MESSAGE_RETRY) {
-        // Max retries reached, AGNSS processing failed
-        Log.println(
-            "S5: Max retries reached after timeout, AGNSS processing failed");
+    // E5.3：到期未结算的条目重传（只重传超时/NACK 的，不整窗重来）
+    agnssRetryTimedOut(now);
+
+    // 完成判定：环空 + 无在途
+    if (agnssWindowEmpty() && agnssRing.empty()) {
+      if (agnssRing.streamDone()) {
+        Log.println("S5: All AGNSS messages settled, injection complete");
+        journalAgnssFreshness();
         transitionBackFromAgnss(now);
-      } else {
-        // Retry sending current AGNSS message
-        Log.printf("S5: Retrying AGNSS message after timeout (attempt %d/%d)\n",
-                   AGNSS_Current_Message_Retry_Count + 1,
-                   MAX_AGNSS_MESSAGE_RETRY);
-        sendCurrentAgnssMessage();
-        AGNSS_Message_Timer_Start = now;
+        break;
       }
-      break;
+      // 注入追上了 BLE 接收：等下一块到达（E5.4 总超时兜底，
+      // 防止客户端中途消失）
     }
 
     // E5.4_AGNSS_Total_Timer_Expired
@@ -830,4 +1254,13 @@ void handleGPS() {
     break;
   }
   }
+
+  // 状态迁移落日志（追加一条 24 字节记录，值没变时 journalWrite
+  // 内部直接跳过，不产生闪存写入）
+  static GpsState_t lastJournaledState = S0_INITIALIZING;
+  if (gSystemInfo.gpsState != lastJournaledState) {
+    uint8_t s = (uint8_t)gSystemInfo.gpsState;
+    journalWrite(JOURNAL_LAST_GPS_STATE, &s, 1);
+    lastJournaledState = gSystemInfo.gpsState;
+  }
 }
@@ -3,7 +3,6 @@
 
 #include "casic_gps_wrapper.h" // For CASIC GPS wrapper
 #include "system_info.h"       // For GpsState_t and gSystemInfo
-#include <vector>              // For AGNSS message queue
 
 // Function to initialize GPS communication and power pin
 void initGPS();
@@ -26,7 +25,9 @@ uint32_t dateTimeToUnixTimestamp(uint16_t year, uint8_t month, uint8_t day,
                                  uint8_t hour, uint8_t minute, uint8_t second);
 
 // AGNSS related functions
-void setAgnssMessageQueue(const std::vector<std::vector<uint8_t>> &messages);
+// BLE 侧收到第一块数据后调用：置位请求标志，状态机在下个循环进 S5，
+// 边收边注（消息暂存在 agnssRing，见 agnss_ring.h）
+void notifyAgnssStreamActive();
 void triggerAgnssProcessing();
 
 // GPS wakeup function to simulate motion detection
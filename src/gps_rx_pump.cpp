@@ -0,0 +1,77 @@
+#include "gps_rx_pump.h"
+#include "logger.h"
+
+GpsRxPump::GpsRxPump()
+    : _serial(nullptr), _mutex(NULL), _fillLength(0), _fillIndex(0),
+      _overrunBytes(0), _started(false) {}
+
+void GpsRxPump::begin(HardwareSerial &serial, unsigned long pollIntervalMs) {
+  _serial = &serial;
+  if (_mutex == NULL) {
+    _mutex = xSemaphoreCreateMutex();
+  }
+  if (!_started) {
+    // timerID 携带 this 指针，静态回调里取回实例
+    _timer.begin(pollIntervalMs, timerCallback, this, true);
+    _timer.start();
+    _started = true;
+    Log.println("GPS RX pump started");
+  }
+}
+
+void GpsRxPump::timerCallback(TimerHandle_t handle) {
+  GpsRxPump *pump = static_cast<GpsRxPump *>(pvTimerGetTimerID(handle));
+  if (pump != nullptr) {
+    pump->pump();
+  }
+}
+
+// 定时器任务上下文：把串口 FIFO 抽到当前填充缓冲区。
+// 即使 loop() 阻塞在 SD 写入上，这里也会继续运行。
+void GpsRxPump::pump() {
+  if (_serial == nullptr) {
+    return;
+  }
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  int avail = _serial->available();
+  while (avail > 0) {
+    int c = _serial->read();
+    if (c < 0) {
+      break;
+    }
+    if (_fillLength < BUFFER_SIZE) {
+      _buffers[_fillIndex][_fillLength++] = (uint8_t)c;
+    } else {
+      // 消费侧落后太多，只能丢字节；计数留给调试
+      _overrunBytes++;
+    }
+    avail--;
+  }
+  xSemaphoreGive(_mutex);
+}
+
+size_t GpsRxPump::acquire(const uint8_t **data) {
+  if (_mutex == NULL) {
+    *data = nullptr;
+    return 0;
+  }
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  uint8_t readyIndex = _fillIndex;
+  size_t readyLength = _fillLength;
+  // 交换：定时器侧改写另一个缓冲区，返回的内容保持稳定
+  _fillIndex ^= 1;
+  _fillLength = 0;
+  xSemaphoreGive(_mutex);
+
+  *data = _buffers[readyIndex];
+  return readyLength;
+}
+
+void GpsRxPump::flush() {
+  if (_mutex == NULL) {
+    return;
+  }
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  _fillLength = 0;
+  xSemaphoreGive(_mutex);
+}
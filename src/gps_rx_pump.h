@@ -0,0 +1,51 @@
+#ifndef GPS_RX_PUMP_H
+#define GPS_RX_PUMP_H
+
+#include <Arduino.h>
+#include <FreeRTOS.h>
+#include <semphr.h>
+
+// GPS 串口接收泵（双缓冲）
+//
+// 主循环在 flushCacheToSD() 等慢操作上阻塞几十毫秒时，UART 硬件 FIFO
+// 会溢出丢失 NMEA 数据。这里用一个 SoftwareTimer（运行在 FreeRTOS
+// 定时器任务里，不受 loop() 阻塞影响）周期性地把串口数据抽到两个
+// 交换缓冲区之一：定时器侧往填充缓冲区写，handleGPS() 通过 acquire()
+// 原子地交换缓冲区并消费已填满的那个。
+class GpsRxPump {
+public:
+  GpsRxPump();
+
+  // 启动接收泵。pollIntervalMs 决定抽取周期（默认 10ms，
+  // 115200 波特率下约 115 字节/周期）。
+  void begin(HardwareSerial &serial, unsigned long pollIntervalMs = 10);
+
+  // 丢弃两个缓冲区中的所有数据（GPS 断电时调用）。
+  void flush();
+
+  // 交换缓冲区并返回刚完成填充的那个。
+  // *data 指向的内容在下一次 acquire() 前保持有效。
+  // 返回可消费的字节数（可能为 0）。
+  size_t acquire(const uint8_t **data);
+
+  // 因消费侧落后导致填充缓冲区装满而丢弃的字节数（调试统计用）
+  uint32_t overrunBytes() const { return _overrunBytes; }
+
+private:
+  static void timerCallback(TimerHandle_t handle);
+  void pump();
+
+  // 单个缓冲区要装得下一次较长的 loop 停顿（200ms @ 115200 ≈ 2.3KB）
+  static const size_t BUFFER_SIZE = 2048;
+
+  HardwareSerial *_serial;
+  SoftwareTimer _timer;
+  SemaphoreHandle_t _mutex;
+  uint8_t _buffers[2][BUFFER_SIZE];
+  size_t _fillLength;  // 填充缓冲区中已写入的字节数
+  uint8_t _fillIndex;  // 当前作为填充侧的缓冲区下标 (0/1)
+  uint32_t _overrunBytes;
+  bool _started;
+};
+
+#endif // GPS_RX_PUMP_H
@@ -11,8 +11,15 @@
  */
 uint32_t last_timestamp = 0;
 uint32_t last_nrf_timestamp = 0;
-bool appendGpxPoint(uint32_t timestamp, double latitude, double longitude,
-                    float altitude_m) {
+
+// 整数四舍五入除法（divisor > 0）
+static inline int32_t div_round_s32(int32_t val, int32_t divisor) {
+  return (val >= 0) ? (val + divisor / 2) / divisor
+                    : (val - divisor / 2) / divisor;
+}
+
+bool appendGpxPointFixed(uint32_t timestamp, int32_t latitude_scaled_1e7,
+                         int32_t longitude_scaled_1e7, int32_t altitude_cm) {
   if (timestamp == 0) {
     Log.println(
         "Warning: Attempted to log point with zero timestamp. Skipping.");
@@ -38,129 +45,21 @@ bool appendGpxPoint(uint32_t timestamp, double latitude, double longitude,
   last_timestamp = timestamp;
   last_nrf_timestamp = millis() / 1000; // 记录上次写入的时间戳
 
-  // 创建 GpxPointInternal 实例并进行缩放
-  GpxPointInternal entry;
+  // 1e7 全精度直通编码器，由编码器按段决定 V1/V2；海拔 cm -> dm
+  GpxPointInternalV2 entry;
   entry.timestamp = timestamp;
-  // 缩放并四舍五入到最近的整数
-  entry.latitude_scaled_1e5 = static_cast<int32_t>(round(latitude * 1e5));
-  entry.longitude_scaled_1e5 = static_cast<int32_t>(round(longitude * 1e5));
-  entry.altitude_m_scaled_1e1 =
-      static_cast<int32_t>(round(altitude_m * 10)); // 海拔缩放到分米
+  entry.latitude_scaled_1e7 = latitude_scaled_1e7;
+  entry.longitude_scaled_1e7 = longitude_scaled_1e7;
+  entry.altitude_m_scaled_1e1 = div_round_s32(altitude_cm, 10);
 
   // 调用 SD handler 来写入数据
   return writeGpsLogDataToSD(entry); // Pass the scaled data struct
 }
 
-GpsDataEncoder::GpsDataEncoder(int full_block_interval)
-    : buffer_size_(0), config_full_block_interval_(
-                           (full_block_interval < 1) ? 1 : full_block_interval),
-      points_since_last_full_block_(0), is_first_point_(true) {
-  // previous_point_ is default constructed
-}
-
-void GpsDataEncoder::write_uint8(uint8_t val) {
-  if (buffer_size_ < sizeof(buffer_)) {
-    buffer_[buffer_size_++] = val;
-  }
-}
-
-void GpsDataEncoder::write_uint32_le(uint32_t val) {
-  if (buffer_size_ + 4 <= sizeof(buffer_)) {
-    buffer_[buffer_size_++] = static_cast<uint8_t>(val & 0xFF);
-    buffer_[buffer_size_++] = static_cast<uint8_t>((val >> 8) & 0xFF);
-    buffer_[buffer_size_++] = static_cast<uint8_t>((val >> 16) & 0xFF);
-    buffer_[buffer_size_++] = static_cast<uint8_t>((val >> 24) & 0xFF);
-  }
-}
-
-void GpsDataEncoder::write_int32_le(int32_t val) {
-  write_uint32_le(static_cast<uint32_t>(
-      val)); // Cast to uint32_t to preserve bit pattern for negative numbers
-}
-
-void GpsDataEncoder::write_varint_s32(int32_t val) {
-  // ZigZag encoding for int32_t
-  uint32_t zz_val =
-      (static_cast<uint32_t>(val) << 1) ^ (static_cast<uint32_t>(val >> 31));
-
-  // Varint encoding
-  while (zz_val >= 0x80 && buffer_size_ < sizeof(buffer_)) {
-    buffer_[buffer_size_++] = static_cast<uint8_t>(zz_val | 0x80);
-    zz_val >>= 7;
-  }
-  if (buffer_size_ < sizeof(buffer_)) {
-    buffer_[buffer_size_++] = static_cast<uint8_t>(zz_val);
-  }
-}
-
-uint32_t GpsDataEncoder::encode(const GpxPointInternal &point) {
-  buffer_size_ = 0; // Reset buffer size for each append
-  bool use_full_block = false;
-
-  if (is_first_point_) {
-    use_full_block = true;
-  } else if (config_full_block_interval_ == 1) {
-    use_full_block = true;
-  } else if (points_since_last_full_block_ >= config_full_block_interval_ - 1) {
-    // After config_full_block_interval_ - 1 DELTA blocks, the next one should
-    // be FULL
-    use_full_block = true;
-  }
-
-  if (use_full_block) {
-    // Write Full Block
-    write_uint8(0xFF); // Header for Full Block
-    write_uint32_le(point.timestamp);
-    write_int32_le(point.latitude_scaled_1e5);
-    write_int32_le(point.longitude_scaled_1e5);
-    write_int32_le(point.altitude_m_scaled_1e1);
-
-    points_since_last_full_block_ = 0; // Reset delta counter
-    is_first_point_ = false;
-  } else {
-    // Write Delta Block
-    int32_t delta_timestamp =
-        point.timestamp -
-        previous_point_.timestamp; // Note: uint - uint could wrap, but here
-                                   // it's fine for typical deltas.
-    int32_t delta_latitude =
-        point.latitude_scaled_1e5 - previous_point_.latitude_scaled_1e5;
-    int32_t delta_longitude =
-        point.longitude_scaled_1e5 - previous_point_.longitude_scaled_1e5;
-    int32_t delta_altitude =
-        point.altitude_m_scaled_1e1 - previous_point_.altitude_m_scaled_1e1;
-
-    uint8_t header = 0x00; // Delta block header base (bit 7 is 0)
-    // Bits: 3 (TS), 2 (Lat), 1 (Lon), 0 (Alt)
-    if (delta_timestamp != 0)
-      header |= (1 << 3);
-    if (delta_latitude != 0)
-      header |= (1 << 2);
-    if (delta_longitude != 0)
-      header |= (1 << 1);
-    if (delta_altitude != 0)
-      header |= (1 << 0);
-
-    write_uint8(header);
-
-    if (delta_timestamp != 0)
-      write_varint_s32(delta_timestamp);
-    if (delta_latitude != 0)
-      write_varint_s32(delta_latitude);
-    if (delta_longitude != 0)
-      write_varint_s32(delta_longitude);
-    if (delta_altitude != 0)
-      write_varint_s32(delta_altitude);
-
-    points_since_last_full_block_++;
-  }
-
-  previous_point_ = point;
-  return buffer_size_;
-}
-
-const uint8_t *GpsDataEncoder::getBuffer() const { return buffer_; }
-
-void GpsDataEncoder::clear() {
-  *this = GpsDataEncoder(config_full_block_interval_);
+bool appendGpxPoint(uint32_t timestamp, double latitude, double longitude,
+                    float altitude_m) {
+  // 兼容旧调用方：缩放到定点后走整数路径
+  return appendGpxPointFixed(timestamp, static_cast<int32_t>(round(latitude * 1e7)),
+                             static_cast<int32_t>(round(longitude * 1e7)),
+                             static_cast<int32_t>(round(altitude_m * 100)));
 }
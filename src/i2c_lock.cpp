@@ -2,18 +2,50 @@
 #include <Arduino.h>
 #include <FreeRTOS.h>
 #include <semphr.h>
+#include <task.h>
 
 static SemaphoreHandle_t i2c_mutex = NULL;
 
+// 各优先级的等待者计数。++/-- 在临界区里做（多任务并发等锁），
+// 读侧只做单字节快照，无需加锁
+static volatile uint8_t i2c_waiters[3] = {0, 0, 0};
+
 static void i2c_lock_init() {
   if (i2c_mutex == NULL) {
     i2c_mutex = xSemaphoreCreateMutex();
   }
 }
 
-void i2c_lock() {
+void i2c_lock(I2cPriority prio) {
   i2c_lock_init();
+  taskENTER_CRITICAL();
+  i2c_waiters[prio]++;
+  taskEXIT_CRITICAL();
   xSemaphoreTake(i2c_mutex, portMAX_DELAY);
+  taskENTER_CRITICAL();
+  i2c_waiters[prio]--;
+  taskEXIT_CRITICAL();
 }
 
 void i2c_unlock() { xSemaphoreGive(i2c_mutex); }
+
+bool i2c_has_higher_waiter(I2cPriority held) {
+  for (uint8_t p = (uint8_t)held + 1; p < 3; p++) {
+    if (i2c_waiters[p] > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void i2c_yield_point(I2cPriority held) {
+  if (!i2c_has_higher_waiter(held)) {
+    return;
+  }
+  // 释放-让渡-重取。FreeRTOS 互斥量按任务优先级唤醒等待者，
+  // vTaskDelay(1) 保证等待者真正先跑一拍（同优先级任务时
+  // 单纯 taskYIELD 可能立刻切回来）
+  i2c_unlock();
+  vTaskDelay(1);
+  i2c_lock(held);
+}
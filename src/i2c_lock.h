@@ -1,14 +1,31 @@
 #pragma once
 #include <Arduino.h>
 
+// I2C 总线访问优先级。显示推帧（1 KB 突发）拿 LOW，加速度计
+// （运动检测，门控 GPS 唤醒）拿 HIGH，其余传感器默认 NORMAL。
+// 长事务的持有者在分段间调 i2c_yield_point()：有更高优先级的
+// 等待者时让出总线，加速度采样抖动不再跟着显示刷新走
+enum I2cPriority : uint8_t {
+  I2C_PRIO_LOW = 0,
+  I2C_PRIO_NORMAL = 1,
+  I2C_PRIO_HIGH = 2,
+};
+
 // I2C Lock API
-void i2c_lock();
+void i2c_lock(I2cPriority prio = I2C_PRIO_NORMAL);
 void i2c_unlock();
 
+// 是否有优先级高于 held 的任务在等锁
+bool i2c_has_higher_waiter(I2cPriority held);
+
+// 长事务的让出点：持有者在两段突发之间调用，有更高优先级的
+// 等待者时释放锁、让调度器切过去、再重新拿回
+void i2c_yield_point(I2cPriority held);
+
 // RAII风格的I2C锁守卫
 class I2C_LockGuard {
 public:
-  I2C_LockGuard() { i2c_lock(); }
+  I2C_LockGuard(I2cPriority prio = I2C_PRIO_NORMAL) { i2c_lock(prio); }
   ~I2C_LockGuard() { i2c_unlock(); }
   // 禁止拷贝和赋值
   I2C_LockGuard(const I2C_LockGuard &) = delete;
@@ -181,10 +181,12 @@ bool writeGpsLogData(const GpxPointInternal &entry) {
     Log.println("Cannot write GPS data: Log file not ready.");
     return false;
   }
-  auto len = gpsDataEncoder.encode(entry);
+  // 编码到栈上的小块，再写入文件（内部闪存路径没有写缓存）
+  uint8_t encodeBuffer[GPZ_MAX_ENCODED_POINT_SIZE];
+  auto len = gpsDataEncoder.encodeTo(entry, encodeBuffer, sizeof(encodeBuffer));
 
   // Write the binary data
-  size_t bytesWritten = currentGpxFile.write(gpsDataEncoder.getBuffer(), len);
+  size_t bytesWritten = currentGpxFile.write(encodeBuffer, len);
 
   if (bytesWritten != len) {
     Log.printf("Failed to write GPS data to %s. Expected %d, wrote %d\n",
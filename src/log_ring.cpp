@@ -0,0 +1,275 @@
+#include "log_ring.h"
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+// 记录布局（变长）：
+//   [len:1]     记录总长（含本字节）
+//   [ms:4]      millis() 时间戳
+//   [fmt:P]     格式串指针（flash 字面量；P = sizeof(uintptr_t)，
+//               目标上 4 字节，宿主机自测时可能是 8）
+//   [args:...]  按格式串扫描顺序打包的参数
+// emit 和 drain 用同一套格式串扫描逻辑，参数不需要类型标签
+
+#define LOG_RING_MASK (LOG_RING_SIZE - 1)
+#define LOG_RECORD_MAX 80 // 头 9B + 6 参数最坏情况（%s×2 + double×4）
+
+static uint8_t ringBuf[LOG_RING_SIZE];
+static uint32_t ringHead = 0; // 读游标（绝对字节计数）
+static uint32_t ringTail = 0; // 写游标
+static uint32_t droppedCount = 0;
+
+static void ringWriteBytes(const void *src, size_t n) {
+  const uint8_t *p = (const uint8_t *)src;
+  for (size_t i = 0; i < n; i++) {
+    ringBuf[(ringTail + i) & LOG_RING_MASK] = p[i];
+  }
+  ringTail += n;
+}
+
+static void ringReadBytes(uint32_t pos, void *dst, size_t n) {
+  uint8_t *p = (uint8_t *)dst;
+  for (size_t i = 0; i < n; i++) {
+    p[i] = ringBuf[(pos + i) & LOG_RING_MASK];
+  }
+}
+
+// 丢最旧记录直到能放下 need 字节
+static void ringMakeRoom(size_t need) {
+  while (LOG_RING_SIZE - (ringTail - ringHead) < need) {
+    uint8_t oldLen = ringBuf[ringHead & LOG_RING_MASK];
+    if (oldLen == 0 || oldLen > LOG_RECORD_MAX) {
+      // 环内容损坏（不应发生），整环清空重来
+      ringHead = ringTail;
+      return;
+    }
+    ringHead += oldLen;
+    droppedCount++;
+  }
+}
+
+// 格式串扫描：跳过 flags/宽度/精度/长度修饰，返回转换字符，
+// *fmt 移动到转换字符之后。返回 0 表示格式串结束
+static char nextSpecifier(const char **fmt) {
+  const char *p = *fmt;
+  while (*p) {
+    if (*p++ != '%') {
+      continue;
+    }
+    if (*p == '%') { // %% 是字面量
+      p++;
+      continue;
+    }
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+      p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+      p++;
+    }
+    if (*p == '.') {
+      p++;
+      while (*p >= '0' && *p <= '9') {
+        p++;
+      }
+    }
+    while (*p == 'l' || *p == 'h' || *p == 'z') {
+      p++;
+    }
+    if (*p == '\0') {
+      break;
+    }
+    char conv = *p++;
+    *fmt = p;
+    return conv;
+  }
+  *fmt = p;
+  return 0;
+}
+
+void logRingEmit(const char *fmt, va_list args) {
+  uint8_t record[LOG_RECORD_MAX];
+  size_t off = 1; // len 最后回填
+
+  uint32_t ms = millis();
+  memcpy(&record[off], &ms, 4);
+  off += 4;
+  uintptr_t fmtPtr = (uintptr_t)fmt;
+  memcpy(&record[off], &fmtPtr, sizeof(fmtPtr));
+  off += sizeof(fmtPtr);
+
+  const char *scan = fmt;
+  char conv;
+  uint8_t argc = 0;
+  while ((conv = nextSpecifier(&scan)) != 0 && argc < LOG_RING_MAX_ARGS) {
+    argc++;
+    switch (conv) {
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G': {
+      double d = va_arg(args, double);
+      if (off + 8 > sizeof(record)) {
+        goto done;
+      }
+      memcpy(&record[off], &d, 8);
+      off += 8;
+      break;
+    }
+    case 's': {
+      const char *s = va_arg(args, const char *);
+      if (s == nullptr) {
+        s = "(null)";
+      }
+      size_t slen = strlen(s);
+      if (slen > LOG_RING_STR_MAX) {
+        slen = LOG_RING_STR_MAX;
+      }
+      if (off + 1 + slen > sizeof(record)) {
+        goto done;
+      }
+      record[off++] = (uint8_t)slen;
+      memcpy(&record[off], s, slen);
+      off += slen;
+      break;
+    }
+    default: { // 整型/字符/指针都按 32 位存（ARM 上 long 也是 32 位）
+      uint32_t v = va_arg(args, uint32_t);
+      if (off + 4 > sizeof(record)) {
+        goto done;
+      }
+      memcpy(&record[off], &v, 4);
+      off += 4;
+      break;
+    }
+    }
+  }
+
+done:
+  record[0] = (uint8_t)off;
+  ringMakeRoom(off);
+  ringWriteBytes(record, off);
+}
+
+bool logRingEmpty() { return ringHead == ringTail; }
+
+uint32_t logRingDroppedCount() { return droppedCount; }
+
+// 单条记录的延迟格式化：重走和 emit 相同的扫描，把每个转换
+// 说明切成单参数子格式串交给 snprintf
+static size_t formatRecord(const uint8_t *rec, uint8_t len, char *out,
+                           size_t cap) {
+  uint32_t ms;
+  uintptr_t fmtPtr;
+  memcpy(&ms, &rec[1], 4);
+  memcpy(&fmtPtr, &rec[5], sizeof(fmtPtr));
+  const char *fmt = (const char *)fmtPtr;
+  size_t argOff = 5 + sizeof(fmtPtr);
+
+  size_t n = snprintf(out, cap, "[+%lu.%03lu] ", (unsigned long)(ms / 1000),
+                      (unsigned long)(ms % 1000));
+  if (n >= cap) {
+    return cap - 1;
+  }
+
+  const char *p = fmt;
+  uint8_t argc = 0;
+  while (*p && n + 1 < cap) {
+    if (*p != '%') {
+      out[n++] = *p++;
+      continue;
+    }
+    if (p[1] == '%') {
+      out[n++] = '%';
+      p += 2;
+      continue;
+    }
+    // 把整个转换说明拷成子格式串
+    const char *specStart = p;
+    const char *scan = p;
+    char conv = nextSpecifier(&scan);
+    if (conv == 0 || argc >= LOG_RING_MAX_ARGS || argOff >= len) {
+      break; // 参数没存全（emit 时截断），剩余部分丢弃
+    }
+    argc++;
+    char spec[16];
+    size_t specLen = (size_t)(scan - specStart);
+    if (specLen >= sizeof(spec)) {
+      specLen = sizeof(spec) - 1;
+    }
+    memcpy(spec, specStart, specLen);
+    spec[specLen] = '\0';
+    p = scan;
+
+    switch (conv) {
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G': {
+      double d;
+      memcpy(&d, &rec[argOff], 8);
+      argOff += 8;
+      n += snprintf(&out[n], cap - n, spec, d);
+      break;
+    }
+    case 's': {
+      uint8_t slen = rec[argOff++];
+      char sbuf[LOG_RING_STR_MAX + 1];
+      memcpy(sbuf, &rec[argOff], slen);
+      sbuf[slen] = '\0';
+      argOff += slen;
+      n += snprintf(&out[n], cap - n, spec, sbuf);
+      break;
+    }
+    default: {
+      uint32_t v;
+      memcpy(&v, &rec[argOff], 4);
+      argOff += 4;
+      n += snprintf(&out[n], cap - n, spec, v);
+      break;
+    }
+    }
+    if (n >= cap) {
+      n = cap - 1;
+      break;
+    }
+  }
+  out[n] = '\0';
+  return n;
+}
+
+size_t logRingDrain(char *out, size_t cap) {
+  if (out == nullptr || cap < 2 || logRingEmpty()) {
+    return 0;
+  }
+  uint8_t rec[LOG_RECORD_MAX];
+  uint8_t len = ringBuf[ringHead & LOG_RING_MASK];
+  if (len == 0 || len > LOG_RECORD_MAX || ringTail - ringHead < len) {
+    ringHead = ringTail; // 环损坏，丢弃全部
+    return 0;
+  }
+  ringReadBytes(ringHead, rec, len);
+  ringHead += len;
+  return formatRecord(rec, len, out, cap);
+}
+
+size_t logRingRawSnapshot(uint8_t *out, size_t cap) {
+  uint32_t pos = ringHead;
+  size_t copied = 0;
+  while (pos != ringTail) {
+    uint8_t len = ringBuf[pos & LOG_RING_MASK];
+    if (len == 0 || len > LOG_RECORD_MAX || ringTail - pos < len) {
+      break;
+    }
+    if (copied + len > cap) {
+      break;
+    }
+    ringReadBytes(pos, &out[copied], len);
+    copied += len;
+    pos += len;
+  }
+  return copied;
+}
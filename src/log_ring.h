@@ -0,0 +1,38 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// 延迟格式化日志环：无主机连接时 Log.printf 不再跑 vsnprintf，
+// 只把「格式串指针 + 原始参数」打包成紧凑记录塞进字节环，
+// 格式化推迟到消费端（串口重新接上后回放，或故障时整环转储）。
+// 格式串是 flash 里的字面量，存 4 字节指针即可；参数按格式串扫描
+// 结果打包：整型/指针 4B，浮点 8B（可变参提升为 double），
+// %s 内联拷贝（截断到 LOG_RING_STR_MAX）。
+//
+// 并发：emit 由 Logger 的互斥锁串行化（和现有 print 路径同一把锁），
+// 环本身不额外加锁；drain 在主循环侧弹出记录后在锁外格式化。
+
+#define LOG_RING_SIZE 1024    // 字节环容量（2 的幂）
+#define LOG_RING_STR_MAX 24   // %s 参数内联拷贝上限
+#define LOG_RING_MAX_ARGS 6   // 单条记录最多的格式参数个数
+
+// 把一次 printf 调用打包进环（调用方持有 Logger 锁）。
+// 环满时丢弃最旧记录腾位置，丢弃计数可查
+void logRingEmit(const char *fmt, va_list args);
+
+// 弹出最旧记录并格式化成文本（含 "[+秒.毫秒] " 前缀），
+// 返回写入 out 的字节数，0 表示环空。格式化在弹出后进行，
+// 调用方无需持锁
+size_t logRingDrain(char *out, size_t cap);
+
+bool logRingEmpty();
+uint32_t logRingDroppedCount(); // 被覆盖丢弃的记录数
+
+// 原始字节转储（故障飞行记录用）：把环内未消费的记录字节
+// 按时间序拷入 out，返回拷贝长度
+size_t logRingRawSnapshot(uint8_t *out, size_t cap);
+
+#endif // LOG_RING_H
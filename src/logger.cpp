@@ -29,3 +29,22 @@ void Logger::lock() {
 }
 
 void Logger::unlock() { xSemaphoreGive(mutex_); }
+
+void Logger::drainDeferred() {
+  if (!enabled_ || serial_ == nullptr || !*serial_ || logRingEmpty()) {
+    return;
+  }
+  // 每次最多回放几条，格式化开销摊到多个调度周期
+  char buf[192];
+  lock();
+  for (int i = 0; i < 4; i++) {
+    size_t n = logRingDrain(buf, sizeof(buf));
+    if (n == 0) {
+      break;
+    }
+    serial_->print(buf);
+  }
+  unlock();
+}
+
+void serviceLogDrain() { Log.drainDeferred(); }
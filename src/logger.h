@@ -1,6 +1,7 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include "log_ring.h"
 #include <Arduino.h>
 #include <FreeRTOS.h>
 #include <semphr.h>
@@ -48,16 +49,29 @@ public:
   void printf(const char *format, ...) {
     lock();
     if (enabled_ && serial_) {
-      char buf[256]; // 缓冲区用于格式化字符串
-      va_list args;
-      va_start(args, format);
-      vsnprintf(buf, sizeof(buf), format, args);
-      va_end(args);
-      serial_->print(buf);
+      if (*serial_) {
+        // 主机在线：维持原样即时格式化输出
+        char buf[256]; // 缓冲区用于格式化字符串
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        serial_->print(buf);
+      } else {
+        // 无主机：只打包格式串指针 + 原始参数进环，
+        // 格式化推迟到串口接上后回放（见 serviceLogDrain）
+        va_list args;
+        va_start(args, format);
+        logRingEmit(format, args);
+        va_end(args);
+      }
     }
     unlock();
   }
 
+  // 主机重新接上后回放环里积压的记录（调度任务周期调用）
+  void drainDeferred();
+
 private:
   void lock();
   void unlock();
@@ -69,4 +83,7 @@ private:
 
 extern Logger Log; // Declare a global Logger instance
 
+// 调度任务入口：Log.drainDeferred() 的自由函数包装
+void serviceLogDrain();
+
 #endif // LOGGER_H
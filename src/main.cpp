@@ -9,11 +9,14 @@
 #include "button_handler.h"
 #include "config.h"
 #include "display_handler.h"
+#include "flight_recorder.h" // 故障飞行记录仪
 #include "gps_handler.h"
 #include "littlefs_handler.h" // Include Internal Flash handler
 #include "logger.h"           // Include Logger
+#include "scheduler.h"        // Cooperative task scheduler
 #include "sd_fs_handler.h"    // Unified SD card file system
 #include "sd_handler.h"       // SD card GPS logging
+#include "state_journal.h"    // Append-only state journal on LittleFS
 #include "system_info.h"      // Include system info
 #include <Arduino.h>
 #include <LIS3DHTR.h>
@@ -30,24 +33,118 @@ const unsigned long BATTERY_UPDATE_INTERVAL_MS = 1000;
 
 SoftwareTimer batteryCheckTimer; // Timer for battery check
 
+// --- 调度器任务（周期见 setup 中的注册） ---
+
+static void taskAccel() {
+  // S2 空闲态：INT1 接好时完全停止轮询，静止期间 I2C 零流量，
+  // 芯片的阈值中断负责报告动静
+  if (gSystemInfo.gpsState == S2_IDLE_GPS_OFF && accelHandler.armMotionWake()) {
+    if (accelHandler.consumeMotionWake()) {
+      gSystemInfo.isStationary = false; // 硬件报告有动静，交给状态机唤醒
+      Bluefruit.Advertising.setFastTimeout(5);
+      Bluefruit.Advertising.start(5);
+    }
+    publishSystemInfo(); // 中断模式下也保持快照新鲜（见函数尾注释）
+    return;
+  }
+  accelHandler.disarmMotionWake();
+
+  // S2 轮询兜底（板子没接 INT1）降到 10Hz ODR 省电；
+  // S4 静止分析和追踪态保持 50Hz
+  accelHandler.setIdleSampling(gSystemInfo.gpsState == S2_IDLE_GPS_OFF);
+
+  // 一次突发事务排空片上 FIFO（最多 32 个样本），逐样本喂分析器
+  if (accelHandler.drainFifo(accelAnalyzer) > 0) {
+    if (accelAnalyzer.isStill()) {
+      gSystemInfo.isStationary = true;
+    } else {
+      gSystemInfo.isStationary = false;
+    }
+    if (accelAnalyzer.hasJump()) {
+      Bluefruit.Advertising.setFastTimeout(5);
+      Bluefruit.Advertising.start(5);
+    }
+  }
+
+  // 10 Hz 的发布兜底快照新鲜度：GPS 关闭的 S2 里
+  // updateGpsSystemInfo 不会跑，状态机/静止/电池字段靠这里带出去。
+  // 发布点全在 loop 任务，整体拷贝不会撞上写了一半的字段
+  publishSystemInfo();
+}
+
+static void taskBmp280() { bmp280Handler.update(); }
+
+static void taskSDIdle() {
+  if (!sdFileSystemReady()) {
+    return; // 分级启动还没挂载 SD，跳过本轮
+  }
+  // 空闲段：缓存到水位后把对齐好的数据写入 SD 卡
+  serviceSDCacheFlush();
+  // 分摊删除过期日志文件（每次最多一个）
+  serviceSDMaintenance();
+}
+
+// --- 分级启动 ---
+// setup() 只做卡定位时间（time-to-fix）的部分：GPS 串口、加速度计、
+// BLE 广播。慢速外设（SD 挂载在老化卡上实测 1-3 s、LittleFS 扫描、
+// 目录清单）推迟到 loop 的前几轮，每轮只推进一级，GPS 摄取在级间
+// 正常调度。SD 就绪前的写入由 writeGpsLogDataToSD() 的
+// sdFileSystemReady() 门卫短路。
+static uint8_t bringupStage = 0;
+
+static bool serviceBringup() {
+  switch (bringupStage) {
+  case 0:
+    // SD 卡：单独占一级，它是最慢的一步
+    if (!initSDFileSystem()) {
+      Log.println("CRITICAL: SD card initialization failed. GPS logging and "
+                  "file transfer disabled.");
+    }
+    break;
+  case 1:
+    // 内部 Flash + 状态日志索引重建
+    initInternalFlash();
+    initStateJournal();
+    break;
+  case 2:
+    // .noinit 里的故障飞行记录落盘（依赖 LittleFS）
+    initFlightRecorder();
+    break;
+  case 3:
+    // 目录清单只是启动自检输出，放在最后
+    Log.println("SD card file system initialized. Root directory:");
+    listSDRootContents();
+    Log.println("Bring-up complete.");
+    break;
+  default:
+    return false; // 全部完成
+  }
+  bringupStage++;
+  return bringupStage <= 3;
+}
+
 void setup() {
   // Initialize Serial communication (for debugging)
-  // Serial.begin(115200); // Keep this for initial boot messages if necessary,
-  // or remove if Log handles all
   Log.begin(); // Initialize our logger
-  delay(1000); // Wait for Serial to initialize
+  // 不再等串口枚举：USB 主机缺席时 printf 走延迟格式化环（log_ring），
+  // 早期消息不会丢；原来的 delay(1000) 白白吃掉 1 s 冷启动
   Log.println("Starting GPS Tracker...");
 
-  // Initialize SD card file system for all operations
-  if (!initSDFileSystem()) {
-    Log.println(
-        "CRITICAL: SD card initialization failed. GPS logging and file transfer disabled.");
-    // Handle error appropriately
-  }
-
-  // Initialize I2C (needed for SSD1306)
+  // Initialize I2C (needed for SSD1306/LIS3DHTR/BMP280)
   Wire.begin();
 
+  // 定位时间敏感的外设最先起：GPS 模块上电即开始搜星，
+  // 加速度计决定状态机能否立刻感知运动
+  initGPS();
+  Log.println("GPS Initialized.");
+
+  // 初始化 LIS3DHTR
+  accelHandler.begin();
+
+  // BLE 紧随其后，尽早可被发现/连接。绑定信息按需惰性读
+  // InternalFS，不依赖下面延后的 initInternalFlash()
+  BleHandler::setup();
+
   // Initialize Display
   if (initDisplay()) {
     Log.println("Display Initialized Successfully.");
@@ -57,10 +154,6 @@ void setup() {
     Log.println("Display Init Failed!");
   }
 
-  // Initialize GPS (will start in OFF state and update gSystemInfo)
-  initGPS();
-  Log.println("GPS Initialized.");
-
   // Initialize Button
   initButton();
   Log.println("Button Handler Initialized.");
@@ -70,21 +163,9 @@ void setup() {
 
   // Initialize BMP280
   bmp280Handler.begin(0x76); // Common I2C addresses 0x76 or 0x77
-  // bmp280Handler.start(1000); // 已移除定时器
-
-  // 初始化 LIS3DHTR
-  accelHandler.begin();
-  // accelHandler.start(50); // 已移除定时器
-
-  // Initialize Internal Flash (for other uses, not GPS logging)
-  initInternalFlash();
-  BleHandler::setup();
 
-  // List SD card contents for verification
-  Log.println("SD card file system initialized. Root directory:");
-  // Use sd_handler's list function
-  extern void listSDRootContents();
-  listSDRootContents();
+  // SD 挂载 / LittleFS / 飞行记录 / 目录清单都不卡首包，
+  // 延后到 loop 的分级启动（serviceBringup）
 
   // No initial GPS message here, handleGPS will manage it.
   Log.println("Setup Complete. Entering loop.");
@@ -92,25 +173,28 @@ void setup() {
   batteryCheckTimer.begin(BATTERY_UPDATE_INTERVAL_MS, updateBatteryInfo, NULL,
                           true); // Start the timer for battery check
   batteryCheckTimer.start();     // Start the timer
+
+  // 注册协作式调度任务。GPS 摄取周期为 0（每次唤醒都跑，
+  // RX 双缓冲兜底）；显示和电池各有自己的 SoftwareTimer，不在此列
+  schedulerAddTask("gps", handleGPS, 0);
+  schedulerAddTask("accel", taskAccel, 100);    // 10 Hz
+  schedulerAddTask("bmp280", taskBmp280, 1000); // 1 Hz
+  schedulerAddTask("sd_idle", taskSDIdle, 250);
+  schedulerAddTask("ble_notify", BleHandler::service, 50); // 推送 + TX 环排空
+  schedulerAddTask("button", serviceButton, 25); // 按键事件分类
+  schedulerAddTask("log", serviceLogDrain, 100); // 回放延迟格式化日志
 }
 
 void loop() {
-  handleGPS(); // Call GPS handler (updates gSystemInfo)
-  bmp280Handler.update();
-  accelHandler.update();
-  if (accelHandler.isOk()) {
-    float total = accelHandler.getTotal();
-    accelAnalyzer.addSample(total);
-    if (accelAnalyzer.isStill()) {
-      gSystemInfo.isStationary = true;
-    } else {
-      gSystemInfo.isStationary = false;
-    }
-    if (accelAnalyzer.hasJump()) {
-      Bluefruit.Advertising.setFastTimeout(5);
-      Bluefruit.Advertising.start(5);
-    }
+  // 执行到期任务，然后睡到最早的截止时间。delay() 经 FreeRTOS
+  // vTaskDelay 进 tickless idle，由 sd_app_evt_wait()/WFE 真正休眠，
+  // BLE/串口/按键中断随时唤醒；比固定 delay(50) 既省电又低延迟
+  uint32_t sleepMs = schedulerRunOnce();
+
+  // 分级启动未完成时每轮推进一级，级间不睡眠，
+  // 让 GPS 摄取插在两个慢速初始化之间跑
+  if (serviceBringup()) {
+    return;
   }
-  // SDSimple removed - use listSDRootContents() instead
-  delay(50); // 100ms delay for loop stability
+  delay(sleepMs);
 }
@@ -0,0 +1,42 @@
+#include "mem_arena.h"
+#include <string.h>
+
+void *MemArena::alloc(size_t n) {
+  // 4 字节对齐：后续分配的结构体成员不产生未对齐访问
+  n = (n + 3) & ~(size_t)3;
+  if (_used + n > _cap) {
+    return nullptr; // 耗尽，调用方走降级路径
+  }
+  void *p = _buf + _used;
+  _used += n;
+  if (_used > _highWater) {
+    _highWater = _used;
+  }
+  return p;
+}
+
+char *MemArena::strdup(const char *s) {
+  size_t len = strlen(s) + 1;
+  char *p = (char *)alloc(len);
+  if (p != nullptr) {
+    memcpy(p, s, len);
+  }
+  return p;
+}
+
+// --- 区域实例 ---
+// BLE 会话：目录快照（512 × 2B）+ 预览点（256 × 12B）+ 余量。
+// 这两块以前是各自为政的常驻静态数组，现在共享会话区域：
+// 后续的会话期分配有统一的家，峰值占用可经 highWater() 观测
+#define BLE_SESSION_ARENA_BYTES 4352
+// 日志纪元：当前文件名等轮换作用域的小分配
+#define LOG_EPOCH_ARENA_BYTES 256
+
+static uint8_t bleSessionBuf[BLE_SESSION_ARENA_BYTES];
+static uint8_t logEpochBuf[LOG_EPOCH_ARENA_BYTES];
+
+static MemArena bleArena(bleSessionBuf, sizeof(bleSessionBuf));
+static MemArena epochArena(logEpochBuf, sizeof(logEpochBuf));
+
+MemArena &bleSessionArena() { return bleArena; }
+MemArena &logEpochArena() { return epochArena; }
@@ -0,0 +1,60 @@
+#ifndef MEM_ARENA_H
+#define MEM_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 固定后备缓冲的指针递增（bump）分配器，按会话划分区域。
+//
+// 长期在线的设备上堆碎片是头号潜在崩溃来源（长运行时间的单元
+// 已观测到 malloc 失败率上升）。这里的模型：分配 = 指针前移，
+// 释放 = 整个区域复位——会话结束时一次性归还，碎片在构造上
+// 不可能出现。后备缓冲是静态的，峰值占用在编译期就定死。
+//
+// 区域与生命周期：
+//   bleSessionArena()  BLE 连接期间的缓存（目录快照、预览点），
+//                      断线时复位（见 BleHandler::disconnect_callback）
+//   logEpochArena()    日志纪元（当前日志文件的生命周期）内的
+//                      分配，文件轮换时复位（见 RotateSDLogFileIfNeeded）
+//
+// A-GNSS 会话的数据本体早已住在固定的 agnssRing 里，不需要区域。
+// 分配失败返回 nullptr，由调用方记日志并走降级路径（与 SD 打开
+// 失败同一套处理习惯）；mark()/release() 支持函数内的临时作用域
+class MemArena {
+public:
+  MemArena(uint8_t *buf, size_t cap)
+      : _buf(buf), _cap(cap), _used(0), _highWater(0) {}
+
+  // 分配 n 字节（向上取整到 4 字节对齐），耗尽返回 nullptr
+  void *alloc(size_t n);
+
+  // 复制字符串进区域（含结尾 0）
+  char *strdup(const char *s);
+
+  // 整区域复位（会话/纪元结束时调用，之前发出的指针全部失效）
+  void reset() { _used = 0; }
+
+  // 临时作用域：记下水位，用完退回
+  size_t mark() const { return _used; }
+  void release(size_t m) {
+    if (m <= _used) {
+      _used = m;
+    }
+  }
+
+  size_t used() const { return _used; }
+  size_t highWater() const { return _highWater; } // 观测峰值（诊断用）
+  size_t capacity() const { return _cap; }
+
+private:
+  uint8_t *_buf;
+  size_t _cap;
+  size_t _used;
+  size_t _highWater;
+};
+
+// 会话区域的全局实例（后备缓冲在 mem_arena.cpp 里静态分配）
+MemArena &bleSessionArena();
+MemArena &logEpochArena();
+
+#endif // MEM_ARENA_H
@@ -0,0 +1,90 @@
+#include "perf_stats.h"
+#include <Arduino.h>
+#include <string.h>
+
+// DWT 周期计数器只在真机上有（CMSIS 的 DWT/CoreDebug 寄存器）。
+// host-test 等环境退回 micros()，分辨率差一些但接口一致。
+#if defined(DWT) && defined(CoreDebug)
+#define PERF_HAS_DWT 1
+#else
+#define PERF_HAS_DWT 0
+#endif
+
+// nRF52840 主频 64 MHz
+#define PERF_CYCLES_PER_US 64
+
+struct PerfSlot {
+  const char *name;
+  PerfSlotStats stats;
+};
+
+static PerfSlot slots[PERF_MAX_SLOTS];
+static uint8_t slotCount = 0;
+static bool dwtReady = false;
+
+void perfInit() {
+  if (dwtReady) {
+    return;
+  }
+#if PERF_HAS_DWT
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // 打开跟踪单元
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk; // 启动周期计数
+#endif
+  dwtReady = true;
+}
+
+uint8_t perfRegister(const char *name) {
+  perfInit();
+  if (slotCount >= PERF_MAX_SLOTS || name == nullptr) {
+    return 0xFF;
+  }
+  slots[slotCount].name = name;
+  memset(&slots[slotCount].stats, 0, sizeof(PerfSlotStats));
+  return slotCount++;
+}
+
+uint32_t perfCycles() {
+#if PERF_HAS_DWT
+  return DWT->CYCCNT;
+#else
+  return micros() * PERF_CYCLES_PER_US;
+#endif
+}
+
+void perfRecord(uint8_t slot, uint32_t cycles) {
+  if (slot >= slotCount) {
+    return;
+  }
+  PerfSlotStats &s = slots[slot].stats;
+  uint32_t us = cycles / PERF_CYCLES_PER_US;
+  s.count++;
+  if (us > s.max_us) {
+    s.max_us = us;
+  }
+  // 桶号 = floor(log2(us))，0 µs 归桶 0，超界进最后一桶
+  uint32_t idx = 0;
+  if (us > 1) {
+    idx = 31 - __builtin_clz(us);
+    if (idx >= PERF_BUCKET_COUNT) {
+      idx = PERF_BUCKET_COUNT - 1;
+    }
+  }
+  s.buckets[idx]++;
+}
+
+uint8_t perfSlotCount() { return slotCount; }
+
+const char *perfSlotName(uint8_t slot) {
+  return slot < slotCount ? slots[slot].name : "";
+}
+
+const PerfSlotStats *perfSlotStats(uint8_t slot) {
+  return slot < slotCount ? &slots[slot].stats : nullptr;
+}
+
+void perfResetAll() {
+  for (uint8_t i = 0; i < slotCount; i++) {
+    memset(&slots[i].stats, 0, sizeof(PerfSlotStats));
+  }
+}
@@ -0,0 +1,42 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <stdint.h>
+
+// 热路径耗时统计。调度器为每个任务槽位记录 DWT 周期计数器的差值，
+// 维护固定桶（对数刻度，微秒）的延迟直方图和最大值水位线，全部在
+// RAM 里，单次记录开销约几十个周期。通过 GET_PERF_STATS (0x25)
+// 导出，部署设备上也能看 p99 级别的 loop 卡顿分布，不再靠猜。
+//
+// 桶刻度：桶 i 覆盖 [2^i, 2^(i+1)) 微秒，最后一个桶收尾上所有
+// 更大的值。12 个桶覆盖 1 µs ~ 2 ms+，足够区分"正常"和"卡了"。
+
+#define PERF_BUCKET_COUNT 12
+#define PERF_MAX_SLOTS 8
+#define PERF_SLOT_NAME_LEN 8 // 导出时的定长名字（截断补零）
+
+struct PerfSlotStats {
+  uint32_t count;                       // 记录次数
+  uint32_t max_us;                      // 最大单次耗时（水位线）
+  uint32_t buckets[PERF_BUCKET_COUNT];  // 对数桶计数
+};
+
+// 初始化 DWT 周期计数器（可重复调用）
+void perfInit();
+
+// 注册一个统计槽位，返回槽位号；满了返回 0xFF（记录调用安全地变成空操作）
+uint8_t perfRegister(const char *name);
+
+// 当前周期计数（64 MHz，自由溢出；差值运算对环绕不敏感）
+uint32_t perfCycles();
+
+// 记录一次耗时（周期数，内部换算微秒入桶）
+void perfRecord(uint8_t slot, uint32_t cycles);
+
+// --- 导出接口（GET_PERF_STATS 用） ---
+uint8_t perfSlotCount();
+const char *perfSlotName(uint8_t slot);
+const PerfSlotStats *perfSlotStats(uint8_t slot);
+void perfResetAll(); // 读取后可选清零，观察新窗口
+
+#endif // PERF_STATS_H
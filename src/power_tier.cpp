@@ -0,0 +1,12 @@
+#include "power_tier.h"
+#include "system_info.h"
+
+PowerTier currentPowerTier() {
+  switch (gSystemInfo.gpsState) {
+  case S2_IDLE_GPS_OFF:
+  case S4_ANALYZING_STILLNESS:
+    return POWER_TIER_IDLE;
+  default:
+    return POWER_TIER_ACTIVE;
+  }
+}
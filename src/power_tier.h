@@ -0,0 +1,18 @@
+#ifndef POWER_TIER_H
+#define POWER_TIER_H
+#include <Arduino.h>
+
+// 系统级功耗档位。GPS 状态机（gps_handler.cpp）是唯一的"动/静"
+// 权威，档位直接从 gSystemInfo.gpsState 推导：S2（GPS 关闭空闲）
+// 和 S4（静止分析）视为空闲档，其余状态为活动档。订阅方
+// （bmp280_handler / display_handler / accel 轮询）在各自的周期
+// 回调里查询档位并降低采样/刷新率；状态机一离开 S2/S4（运动、
+// BLE 唤醒），下一个调度周期自动恢复，无需额外的恢复通知
+enum PowerTier : uint8_t {
+  POWER_TIER_ACTIVE = 0, // 追踪/搜星中，全速采样
+  POWER_TIER_IDLE = 1,   // S2/S4 静止，降频省电
+};
+
+PowerTier currentPowerTier();
+
+#endif // POWER_TIER_H
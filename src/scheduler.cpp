@@ -0,0 +1,74 @@
+#include "scheduler.h"
+#include "perf_stats.h"
+#include <Arduino.h>
+
+#define SCHEDULER_MAX_TASKS 8
+
+struct SchedulerTask {
+  const char *name;
+  SchedulerTaskFn fn;
+  uint32_t period_ms;
+  uint32_t next_due_ms;
+  uint8_t perf_slot; // 每个任务一个延迟直方图槽位
+};
+
+// 运行任务并把耗时记进对应的直方图
+static inline void runTimed(SchedulerTask &task) {
+  uint32_t c0 = perfCycles();
+  task.fn();
+  perfRecord(task.perf_slot, perfCycles() - c0);
+}
+
+static SchedulerTask tasks[SCHEDULER_MAX_TASKS];
+static uint8_t taskCount = 0;
+
+bool schedulerAddTask(const char *name, SchedulerTaskFn fn,
+                      uint32_t period_ms) {
+  if (taskCount >= SCHEDULER_MAX_TASKS || fn == nullptr) {
+    return false;
+  }
+  tasks[taskCount].name = name;
+  tasks[taskCount].fn = fn;
+  tasks[taskCount].period_ms = period_ms;
+  tasks[taskCount].next_due_ms = millis(); // 注册即到期，首轮就运行
+  tasks[taskCount].perf_slot = perfRegister(name);
+  taskCount++;
+  return true;
+}
+
+uint32_t schedulerRunOnce() {
+  uint32_t now = millis();
+  uint32_t sleepMs = SCHEDULER_MAX_SLEEP_MS;
+
+  for (uint8_t i = 0; i < taskCount; i++) {
+    SchedulerTask &task = tasks[i];
+
+    if (task.period_ms == 0) {
+      // 每次唤醒都运行，不参与截止时间计算
+      runTimed(task);
+      continue;
+    }
+
+    // 带环绕安全的到期判断
+    if ((int32_t)(now - task.next_due_ms) >= 0) {
+      runTimed(task);
+      // 按周期步进而不是 now + period，避免周期漂移；
+      // 落后太多（>1 周期）时直接重新锚定，不追补
+      task.next_due_ms += task.period_ms;
+      if ((int32_t)(now - task.next_due_ms) >= 0) {
+        task.next_due_ms = now + task.period_ms;
+      }
+      now = millis(); // 任务可能跑了一阵，刷新基准
+    }
+
+    int32_t remaining = (int32_t)(task.next_due_ms - now);
+    if (remaining < 1) {
+      remaining = 1;
+    }
+    if ((uint32_t)remaining < sleepMs) {
+      sleepMs = (uint32_t)remaining;
+    }
+  }
+
+  return sleepMs;
+}
@@ -0,0 +1,30 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+// 简单的协作式任务调度器，替代 loop() 里的固定 delay(50) 超循环。
+// 每个任务有自己的周期；schedulerRunOnce() 执行所有到期任务并返回
+// 距最早截止时间的毫秒数，loop() 据此 delay() 入睡——Adafruit 核心的
+// delay() 走 FreeRTOS vTaskDelay，tickless idle 下由 SoftDevice 的
+// sd_app_evt_wait()/WFE 真正休眠，中断（BLE、串口、按键）随时唤醒。
+//
+// period_ms == 0 的任务在每次唤醒时都运行（GPS 摄取），不参与
+// 截止时间计算。
+
+typedef void (*SchedulerTaskFn)();
+
+// 注册一个任务。period_ms 为 0 表示每次唤醒都运行。
+// 任务表为固定大小，超出容量时返回 false。
+bool schedulerAddTask(const char *name, SchedulerTaskFn fn, uint32_t period_ms);
+
+// 执行所有到期任务，返回距最早截止时间的毫秒数（可直接交给 delay()）。
+// 返回值被钳制在 [1, SCHEDULER_MAX_SLEEP_MS] 内。
+uint32_t schedulerRunOnce();
+
+// 休眠上限：即使所有周期任务都很远，也最多睡这么久，
+// 保证 period 0 的任务（GPS 摄取）有足够的服务频率
+// （GPS RX 双缓冲在 115200 波特下约可容纳 170ms 的数据）
+#define SCHEDULER_MAX_SLEEP_MS 100
+
+#endif // SCHEDULER_H
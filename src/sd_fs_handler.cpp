@@ -6,23 +6,28 @@
 // Global SdFat instance
 SdFat sd;
 
+static bool sdReady = false;
+
 // Initialize SD card file system
 bool initSDFileSystem() {
     Log.println("Initializing SD card file system...");
-    
+
     // Initialize SPI
     SPI.begin();
-    
+
     // Initialize SD card
     if (!sd.begin(LORA_CS, 100000)) {
         Log.println("SD card initialization failed!");
         return false;
     }
-    
+
+    sdReady = true;
     Log.println("SD card file system initialized successfully");
     return true;
 }
 
+bool sdFileSystemReady() { return sdReady; }
+
 // Directory operations
 bool listDirectory(const char *path) {
     SdFile dir;
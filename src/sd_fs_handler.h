@@ -13,6 +13,10 @@ extern SdFat sd;
 // Initialize SD card file system
 bool initSDFileSystem();
 
+// 挂载是否已成功完成。SD 挂载从 setup() 挪到了 loop 的分级启动
+// （见 main.cpp），挂载前到达的写入/维护路径用它短路
+bool sdFileSystemReady();
+
 // Directory operations
 bool listDirectory(const char *path);
 bool createDirectory(const char *path);
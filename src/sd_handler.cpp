@@ -2,98 +2,293 @@
 #include "config.h" // Include for MAX_GPX_FILES
 #include "gpx_logger.h"
 #include "logger.h"
+#include "mem_arena.h"     // 日志纪元区域（当前文件名驻留于此）
 #include "sd_fs_handler.h" // Use unified SD file system handler
 #include <Arduino.h>
 #include <SdFat.h>
 #include <TimeLib.h> // Include for time functions (year, month, day)
 #include <algorithm> // For std::sort
 #include <cstdio>    // For sprintf
-#include <string>    // Using std::string for sorting
-#include <vector>    // Using vector for easier list management
 
 // Global SdFat instance from sd_simple.cpp
 extern SdFat sd;
 
 // Global variables to keep track of the current file
 static SdFile currentGpxFile;
-static String currentFilename = "";
+// 文件名住在日志纪元 arena 里（轮换时复位 + 重新 strdup），
+// 不再用 String——堆上长期反复分配是长运行时间设备的碎片来源
+static const char *currentFilename = "";
 static uint32_t currentFileDate = 0; // Store date as YYYYMMDD for comparison
 static bool isFileOpen = false;
 
 static GpsDataEncoder gpsDataEncoder(64);
 
-// 4KB缓存相关变量
-static uint8_t writeCache[4096];
-static size_t cachePosition = 0;
-static bool cacheDirty = false;
+// --- 日志清单 (manifest) ---
+// 启动时逐项扫描 SD 根目录在一年日志量的卡上要花数秒，
+// 午夜轮换时的同步扫描还会造成采样空洞。改为维护一个持久化清单
+// 文件：轮换时增量更新，启动/清理/列目录都读清单而不是走 FAT 目录。
+#define LOG_MANIFEST_PATH "/logmf.bin"
+#define LOG_MANIFEST_MAGIC 0x464D474C // "LGMF"
+#define MAX_MANIFEST_ENTRIES 400      // 超过一年的每日日志
+
+#pragma pack(push, 1)
+struct LogManifestEntry {
+  char name[16];           // "YYYYMMDD.gpx"，NUL 结尾
+  uint32_t size;           // 文件大小（轮换关闭时更新）
+  uint32_t firstTimestamp; // 文件内第一个点的 Unix 时间戳
+  uint32_t lastTimestamp;  // 文件内最后一个点的 Unix 时间戳
+};
+#pragma pack(pop)
+
+static LogManifestEntry logManifest[MAX_MANIFEST_ENTRIES];
+static uint16_t logManifestCount = 0;
+static bool logManifestLoaded = false;
+
+// 当前文件的时间范围（RAM 维护，轮换时写进清单）
+static uint32_t currentFileFirstTs = 0;
+static uint32_t currentFileLastTs = 0;
+
+// 过期文件延迟删除队列：清理决策即时做，真正的删除在空闲钩子里
+// 分摊进行，一次最多删一个文件
+static char pendingDeleteQueue[8][16];
+static uint8_t pendingDeleteCount = 0;
+
+static bool saveLogManifest() {
+  SdFile f;
+  if (!f.open(LOG_MANIFEST_PATH, O_CREAT | O_WRITE | O_TRUNC)) {
+    Log.println("Failed to open log manifest for writing");
+    return false;
+  }
+  uint32_t magic = LOG_MANIFEST_MAGIC;
+  f.write(&magic, 4);
+  f.write(&logManifestCount, 2);
+  f.write(logManifest, sizeof(LogManifestEntry) * logManifestCount);
+  f.sync();
+  f.close();
+  return true;
+}
 
-// Helper function to manage old log files - keeps total file size below MAX_FILE_SIZE
-void manageOldSDFiles() {
-    std::vector<String> gpxFiles;
-    
-    SdFile root;
-    if (!root.open("/")) {
-        Log.println("Failed to open root directory for cleanup");
-        return;
+// 没有清单（第一次启动/清单损坏）时扫描一次目录重建
+static void rebuildLogManifest() {
+  logManifestCount = 0;
+
+  SdFile root;
+  if (!root.open("/")) {
+    Log.println("Manifest rebuild: failed to open root");
+    return;
+  }
+  SdFile file;
+  while (file.openNext(&root, O_READ) &&
+         logManifestCount < MAX_MANIFEST_ENTRIES) {
+    char filename[32];
+    file.getName(filename, sizeof(filename));
+    size_t nameLen = strlen(filename);
+    if (nameLen < 16 && nameLen > 4 &&
+        strcmp(filename + nameLen - 4, ".gpx") == 0) {
+      LogManifestEntry &entry = logManifest[logManifestCount++];
+      memset(&entry, 0, sizeof(entry));
+      strncpy(entry.name, filename, sizeof(entry.name) - 1);
+      entry.size = file.fileSize();
     }
+    file.close();
+  }
+  root.close();
 
-    SdFile file;
-    while (file.openNext(&root, O_READ)) {
-        char filename[32];
-        file.getName(filename, sizeof(filename));
-        
-        String name = String(filename);
-        if (name.endsWith(".gpx")) {
-            gpxFiles.push_back(name);
-        }
-        file.close();
+  // 按文件名排序（YYYYMMDD 命名即按时间排序）
+  std::sort(logManifest, logManifest + logManifestCount,
+            [](const LogManifestEntry &a, const LogManifestEntry &b) {
+              return strcmp(a.name, b.name) < 0;
+            });
+
+  saveLogManifest();
+  Log.printf("Log manifest rebuilt: %d entries\n", (int)logManifestCount);
+}
+
+static void loadLogManifest() {
+  if (logManifestLoaded) {
+    return;
+  }
+  SdFile f;
+  bool valid = false;
+  if (f.open(LOG_MANIFEST_PATH, O_READ)) {
+    uint32_t magic = 0;
+    uint16_t count = 0;
+    if (f.read(&magic, 4) == 4 && magic == LOG_MANIFEST_MAGIC &&
+        f.read(&count, 2) == 2 && count <= MAX_MANIFEST_ENTRIES) {
+      int expected = (int)(sizeof(LogManifestEntry) * count);
+      if (f.read(logManifest, expected) == expected) {
+        logManifestCount = count;
+        valid = true;
+      }
     }
-    root.close();
+    f.close();
+  }
+  if (!valid) {
+    rebuildLogManifest();
+  } else {
+    Log.printf("Log manifest loaded: %d entries\n", (int)logManifestCount);
+  }
+  logManifestLoaded = true;
+}
 
-    // Sort files alphabetically (which is chronologically for YYYYMMDD format)
-    std::sort(gpxFiles.begin(), gpxFiles.end());
+static LogManifestEntry *findManifestEntry(const char *name) {
+  for (uint16_t i = 0; i < logManifestCount; i++) {
+    if (strcmp(logManifest[i].name, name) == 0) {
+      return &logManifest[i];
+    }
+  }
+  return nullptr;
+}
+
+static void manifestRemoveEntry(const char *name) {
+  for (uint16_t i = 0; i < logManifestCount; i++) {
+    if (strcmp(logManifest[i].name, name) == 0) {
+      memmove(&logManifest[i], &logManifest[i + 1],
+              sizeof(LogManifestEntry) * (logManifestCount - i - 1));
+      logManifestCount--;
+      return;
+    }
+  }
+}
+
+// 轮换时把关闭文件的最终大小和时间范围写回清单
+static void manifestUpdateClosedFile(const char *name, uint32_t size) {
+  LogManifestEntry *entry = findManifestEntry(name);
+  if (entry == nullptr && logManifestCount < MAX_MANIFEST_ENTRIES) {
+    entry = &logManifest[logManifestCount++];
+    memset(entry, 0, sizeof(*entry));
+    strncpy(entry->name, name, sizeof(entry->name) - 1);
+  }
+  if (entry != nullptr) {
+    entry->size = size;
+    if (currentFileFirstTs != 0) {
+      entry->firstTimestamp = currentFileFirstTs;
+    }
+    if (currentFileLastTs != 0) {
+      entry->lastTimestamp = currentFileLastTs;
+    }
+  }
+  saveLogManifest();
+}
+
+// 写缓存相关变量（大小与冲刷策略见 config.h 的 SD Write Cache 设置）
+static uint8_t writeCache[SD_WRITE_CACHE_SIZE];
+static size_t cachePosition = 0;
+static bool cacheDirty = false;
+
+// --- 稀疏时间索引 ---
+// GPZ 文件每 64 个点有一个全量块（见 GpsDataEncoder），记下每个
+// 全量块的时间戳 + 文件偏移就能把「取某时间段」映射成字节范围。
+// 活动文件的索引在 RAM 里维护，轮换时写成同名 .idx 边车文件。
+// 256 条 × 8B = 2 KB，按 10 s 采样覆盖 45 小时，单日文件绰绰有余
+#define TIME_INDEX_MAGIC 0x58444954 // "TIDX"
+#define TIME_INDEX_MAX_ENTRIES 256
+
+#pragma pack(push, 1)
+struct TimeIndexEntry {
+  uint32_t timestamp; // 全量块的 Unix 时间戳
+  uint32_t offset;    // 全量块在文件内的字节偏移
+};
+#pragma pack(pop)
+
+static TimeIndexEntry timeIndex[TIME_INDEX_MAX_ENTRIES];
+static uint16_t timeIndexCount = 0;
+
+// "YYYYMMDD.gpx" → "YYYYMMDD.idx"
+static bool idxPathFor(const char *gpxName, char *out, size_t cap) {
+  size_t len = strlen(gpxName);
+  if (len < 4 || len >= cap || strcmp(gpxName + len - 4, ".gpx") != 0) {
+    return false;
+  }
+  memcpy(out, gpxName, len - 4);
+  memcpy(out + len - 4, ".idx", 5);
+  return true;
+}
+
+// 轮换关闭文件时把 RAM 索引写成边车文件
+static void saveTimeIndex(const char *gpxName) {
+  char idxName[20];
+  if (timeIndexCount == 0 || !idxPathFor(gpxName, idxName, sizeof(idxName))) {
+    return;
+  }
+  SdFile f;
+  if (!f.open(idxName, O_CREAT | O_WRITE | O_TRUNC)) {
+    Log.printf("Failed to write time index %s\n", idxName);
+    return;
+  }
+  uint32_t magic = TIME_INDEX_MAGIC;
+  f.write(&magic, 4);
+  f.write(&timeIndexCount, 2);
+  f.write(timeIndex, sizeof(TimeIndexEntry) * timeIndexCount);
+  f.sync();
+  f.close();
+  Log.printf("Time index %s: %u full blocks\n", idxName,
+             (unsigned)timeIndexCount);
+}
+
+// Helper function to manage old log files - keeps total file size below MAX_FILE_SIZE
+// 总量统计直接读 RAM 清单（无目录扫描）；超限时只把最旧的文件放进
+// 延迟删除队列，真正的 sd.remove() 由 serviceSDMaintenance() 在空闲
+// 段分摊执行，轮换热路径不再阻塞在擦除上。
+void manageOldSDFiles() {
+    loadLogManifest();
 
-    // Calculate total file size
     uint32_t totalFileSize = 0;
-    std::vector<std::pair<String, uint32_t>> fileDetails;
-
-    for (const auto &filename : gpxFiles) {
-        SdFile file;
-        if (file.open(filename.c_str(), O_READ)) {
-            uint32_t fileSize = file.fileSize();
-            totalFileSize += fileSize;
-            fileDetails.push_back(std::make_pair(filename, fileSize));
-            file.close();
-        }
+    for (uint16_t i = 0; i < logManifestCount; i++) {
+        totalFileSize += logManifest[i].size;
     }
 
-    // Check if we need to delete files
     Log.printf("Total GPX file size: %lu bytes, MAX_FILE_SIZE: %lu bytes\n",
                totalFileSize, (uint32_t)MAX_FILE_SIZE);
 
-    if (totalFileSize > MAX_FILE_SIZE) {
-        // Delete oldest files until we get below the limit
-        for (size_t i = 0; i < fileDetails.size(); ++i) {
-            Log.printf("Deleting old log file: %s (%lu bytes)\n",
-                       fileDetails[i].first.c_str(), fileDetails[i].second);
-
-            if (!sd.remove(fileDetails[i].first.c_str())) {
-                Log.printf("Failed to delete %s\n", fileDetails[i].first.c_str());
-                // Continue trying to delete others even if one fails
-            } else {
-                totalFileSize -= fileDetails[i].second;
-                Log.printf("Remaining file size: %lu bytes\n", totalFileSize);
-
-                // Check if we're below the threshold now
-                if (totalFileSize <= MAX_FILE_SIZE) {
-                    Log.println("Successfully cleaned up to target size");
-                    break;
-                }
-            }
+    // 清单按文件名（即日期）有序，从最旧的开始标记删除
+    bool manifestChanged = false;
+    uint16_t victim = 0;
+    while (totalFileSize > MAX_FILE_SIZE && victim < logManifestCount &&
+           pendingDeleteCount < (sizeof(pendingDeleteQueue) / sizeof(pendingDeleteQueue[0]))) {
+        // 不能删当前正在写的文件
+        if (strcmp(currentFilename, logManifest[victim].name) == 0) {
+            victim++;
+            continue;
         }
+        Log.printf("Queueing old log file for deletion: %s (%lu bytes)\n",
+                   logManifest[victim].name, logManifest[victim].size);
+        strncpy(pendingDeleteQueue[pendingDeleteCount], logManifest[victim].name,
+                sizeof(pendingDeleteQueue[0]) - 1);
+        pendingDeleteQueue[pendingDeleteCount][sizeof(pendingDeleteQueue[0]) - 1] = '\0';
+        pendingDeleteCount++;
+        totalFileSize -= logManifest[victim].size;
+        // 清单里立即移除，后续统计不再把它算进总量
+        manifestRemoveEntry(logManifest[victim].name);
+        manifestChanged = true;
+    }
+    if (manifestChanged) {
+        saveLogManifest();
     }
 }
 
+// 空闲钩子：每次最多删除一个已入队的过期文件，把 FAT 链释放的
+// 耗时摊到多个 loop 周期里。返回 true 表示本次有干活。
+bool serviceSDMaintenance() {
+    if (pendingDeleteCount == 0) {
+        return false;
+    }
+    pendingDeleteCount--;
+    const char *victim = pendingDeleteQueue[pendingDeleteCount];
+    if (sd.remove(victim)) {
+        Log.printf("Deleted old log file: %s\n", victim);
+    } else {
+        Log.printf("Failed to delete %s\n", victim);
+        // 清单里已经移除；下次重建清单时若文件还在会被重新收录
+    }
+    // 边车时间索引跟着日志文件一起删，不留孤儿
+    char idxName[20];
+    if (idxPathFor(victim, idxName, sizeof(idxName))) {
+        sd.remove(idxName);
+    }
+    return true;
+}
+
 // Function to check if the date has changed and rotate log file if needed
 // Also handles opening the file initially or after an error
 bool RotateSDLogFileIfNeeded(uint32_t timestamp) {
@@ -110,25 +305,35 @@ bool RotateSDLogFileIfNeeded(uint32_t timestamp) {
       // 文件切换前，先flush缓存中的数据
       if (isFileOpen) {
         flushCacheToSD();       // 确保缓存数据写入当前文件
+        uint32_t closedSize = currentGpxFile.fileSize();
         currentGpxFile.close(); // Close the previous day's file
         isFileOpen = false;     // Mark as closed
-        Log.printf("Closed log file: %s\n", currentFilename.c_str());
+        Log.printf("Closed log file: %s\n", currentFilename);
+        // 增量更新清单：写入关闭文件的最终大小和时间范围
+        manifestUpdateClosedFile(currentFilename, closedSize);
+        // 时间索引落成边车文件，READ_TIME_RANGE 直接查
+        saveTimeIndex(currentFilename);
       }
 
         // Format the new filename: YYYYMMDD.gpx
         char filenameBuffer[14]; // "YYYYMMDD.gpx" + null terminator
         sprintf(filenameBuffer, "%04d%02d%02d.gpx", y, m, d);
-        currentFilename = String(filenameBuffer);
+        // 旧纪元结束：上个文件名用完了，整区域复位后驻留新文件名
+        logEpochArena().reset();
+        currentFilename = logEpochArena().strdup(filenameBuffer);
+        if (currentFilename == nullptr) {
+            currentFilename = ""; // 256B 的区域装不下 13B 文件名不可能发生
+        }
         currentFileDate = newDate; // Update the current date
 
-        Log.printf("Switching to log file: %s\n", currentFilename.c_str());
+        Log.printf("Switching to log file: %s\n", currentFilename);
 
         // Manage old files before opening the new one
         manageOldSDFiles();
 
         // Open the new file in write mode (append/create)
-        if (!currentGpxFile.open(currentFilename.c_str(), O_CREAT | O_WRITE | O_APPEND)) {
-            Log.printf("Failed to open log file: %s\n", currentFilename.c_str());
+        if (!currentGpxFile.open(currentFilename, O_CREAT | O_WRITE | O_APPEND)) {
+            Log.printf("Failed to open log file: %s\n", currentFilename);
             currentFilename = ""; // Reset filename if open failed
             currentFileDate = 0;  // Reset date
             isFileOpen = false;   // Ensure marked as not open
@@ -137,7 +342,12 @@ bool RotateSDLogFileIfNeeded(uint32_t timestamp) {
             // Open succeeded
             isFileOpen = true; // Mark as open
             gpsDataEncoder.clear();
-            Log.printf("Successfully opened log file: %s\n", currentFilename.c_str());
+            currentFileFirstTs = 0;
+            currentFileLastTs = 0;
+            // 新文件的时间索引从零开始。重启续写当天文件时索引只
+            // 覆盖重启后的部分，更早的时间查询退化为从文件头开始
+            timeIndexCount = 0;
+            Log.printf("Successfully opened log file: %s\n", currentFilename);
         }
     }
 
@@ -148,9 +358,11 @@ bool RotateSDLogFileIfNeeded(uint32_t timestamp) {
 // Initialize SD card for GPS logging
 bool initSDForGPSLogging() {
     Log.println("Initializing SD card for GPS logging...");
-    
+
     // Use unified SD file system (already initialized in main.cpp)
-    // Just perform cleanup and reset state
+    // 读取（必要时重建）日志清单，再据此做清理决策；
+    // 正常启动路径只读一个小清单文件，不再遍历整个根目录
+    loadLogManifest();
     manageOldSDFiles();
     
     // Reset state on initialization
@@ -178,7 +390,7 @@ bool flushCacheToSD() {
 
   if (bytesWritten != cachePosition) {
     Log.printf("Failed to flush cache to %s. Expected %d, wrote %d\n",
-               currentFilename.c_str(), (int)cachePosition, (int)bytesWritten);
+               currentFilename, (int)cachePosition, (int)bytesWritten);
     return false;
   }
 
@@ -197,18 +409,202 @@ bool flushCacheToSD() {
 // 获取缓存使用情况
 std::size_t getCacheUsage() { return cachePosition; }
 
+// 空闲钩子：缓存到达水位后，把整扇区对齐的部分写入 SD 卡。
+// 写入发生在 loop 的空闲段而不是 writeGpsLogDataToSD() 的热路径上。
+//
+// 写回切片：每次最多写 SD_FLUSH_BUDGET_MS 的 SD 工作量、按单个
+// 扇区推进——老化卡上一次整缓存写入实测能卡 80-200 ms，期间 UART
+// RX 溢出、按键丢失；切片后每趟 loop 的 SD 开销有上界，剩余部分
+// 下一趟接着写。缓存真正装不下时 writeGpsLogDataToSD() 里的同步
+// flushCacheToSD() 仍是最后兜底。
+bool serviceSDCacheFlush() {
+  if (!cacheDirty || cachePosition < SD_CACHE_FLUSH_WATERMARK) {
+    return true; // 还没到水位，什么都不做
+  }
+  if (!isFileOpen) {
+    return false;
+  }
+
+  unsigned long sliceStart = millis();
+  size_t flushed = 0;
+  bool writeError = false;
+
+  // 逐扇区推进；第一个扇区无条件写（保证前进），之后每片前检查预算
+  while (cachePosition - flushed >= SD_ERASE_ALIGN_BYTES) {
+    if (flushed > 0 && millis() - sliceStart >= SD_FLUSH_BUDGET_MS) {
+      break; // 预算用完，剩余数据下一趟 loop 继续
+    }
+    size_t bytesWritten =
+        currentGpxFile.write(writeCache + flushed, SD_ERASE_ALIGN_BYTES);
+    if (bytesWritten != SD_ERASE_ALIGN_BYTES) {
+      Log.printf("Aligned flush failed. Expected %d, wrote %d\n",
+                 SD_ERASE_ALIGN_BYTES, (int)bytesWritten);
+      writeError = true;
+      break;
+    }
+    flushed += SD_ERASE_ALIGN_BYTES;
+  }
+
+  if (flushed > 0) {
+    currentGpxFile.sync();
+
+    // 已写部分移出缓存，尾部残留搬到头部等下一次冲刷
+    size_t remaining = cachePosition - flushed;
+    if (remaining > 0) {
+      memmove(writeCache, writeCache + flushed, remaining);
+    }
+    cachePosition = remaining;
+    cacheDirty = (remaining > 0);
+
+    Log.printf("Idle-flushed %d aligned bytes to SD (remainder %d, %lu ms)\n",
+               (int)flushed, (int)remaining,
+               (unsigned long)(millis() - sliceStart));
+  }
+
+  return !writeError;
+}
+
+// --- 最近航迹 RAM 环 ---
+// 伴侣应用的「最近一小时」视图反复下载刚写进 SD 的数据，还迫使
+// 空闲态给 SD 上电（卡初始化是最凶的唤醒功耗尖峰之一）。这里把
+// 最近写入的编码字节镜像进一个 RAM 环，RECENT_TRACK 命令直接从
+// 环里答，零 SD I/O；更老的范围走既有的 READ_TIME_RANGE + READ_RANGE。
+//
+// 环是逻辑位置寻址（单调总字节数取模），淘汰即被新字节覆盖。
+// 并发模型同 battery_telemetry：生产者（loop 任务）先写槽位再发布
+// 计数，消费者（BLE 任务）拷贝后复验位置仍未被覆盖。增量约
+// 0.7 B/s（10 s 采样 × ~7 B/点），传输中途被覆盖实际不会发生
+#define RECENT_RING_BYTES 6144 // ~880 点 ≈ 2.4 小时（10 s 间隔）
+#define RECENT_INDEX_MAX 24    // 全量块引用；~460 B/段 → 环内约 13 段
+
+struct RecentBlockRef {
+  uint32_t timestamp; // 全量块的时间戳
+  uint32_t pos;       // 块首的逻辑位置
+};
+
+static uint8_t recentRing[RECENT_RING_BYTES];
+static volatile uint32_t recentTotal = 0; // 已写入的逻辑总字节数
+static RecentBlockRef recentIndex[RECENT_INDEX_MAX];
+static volatile uint32_t recentBlockTotal = 0; // 已记录的全量块总数
+
+// 生产者：把刚编码好的点字节镜像进环（loop 任务调用）
+static void recentTrackAppend(const uint8_t *data, size_t len,
+                              uint32_t timestamp, bool isFullBlock) {
+  uint32_t total = recentTotal;
+  if (isFullBlock) {
+    RecentBlockRef &ref = recentIndex[recentBlockTotal % RECENT_INDEX_MAX];
+    ref.timestamp = timestamp;
+    ref.pos = total;
+    recentBlockTotal = recentBlockTotal + 1;
+  }
+  // 至多两段 memcpy 跨过环尾
+  uint32_t w = total % RECENT_RING_BYTES;
+  size_t tail = RECENT_RING_BYTES - w;
+  if (len <= tail) {
+    memcpy(&recentRing[w], data, len);
+  } else {
+    memcpy(&recentRing[w], data, tail);
+    memcpy(&recentRing[0], data + tail, len - tail);
+  }
+  __DMB(); // 槽位先落，计数后发布
+  recentTotal = total + (uint32_t)len;
+}
+
+uint8_t recentTrackResolve(uint32_t startTs, uint32_t endTs, uint32_t *outPos,
+                           uint32_t *outEnd) {
+  uint32_t total = recentTotal;
+  uint32_t blkTotal = recentBlockTotal;
+  if (blkTotal == 0) {
+    return RECENT_TRACK_MISS;
+  }
+  if (endTs == 0) {
+    endTs = 0xFFFFFFFF; // 0 = 到当前为止
+  }
+  uint32_t oldestPos = (total > RECENT_RING_BYTES)
+                           ? total - RECENT_RING_BYTES
+                           : 0;
+
+  // 扫描仍有效的全量块引用，找：起点 = 时间戳 ≤ startTs 的最后一块
+  // （保证解码链从全量块开始且覆盖 startTs），终点 = 时间戳 > endTs
+  // 的第一块（其后的点都晚于 endTs）
+  bool haveStart = false, haveOldest = false;
+  uint32_t startPos = 0, endPos = total, oldestTs = 0, oldestBlockPos = 0;
+  uint32_t first = (blkTotal > RECENT_INDEX_MAX) ? blkTotal - RECENT_INDEX_MAX
+                                                 : 0;
+  for (uint32_t i = first; i < blkTotal; i++) {
+    RecentBlockRef ref = recentIndex[i % RECENT_INDEX_MAX];
+    if (recentBlockTotal - i > RECENT_INDEX_MAX) {
+      continue; // 拷贝期间被生产者覆盖，放弃该引用
+    }
+    if (ref.pos < oldestPos) {
+      continue; // 段首字节已被环淘汰，不可解码
+    }
+    if (!haveOldest) {
+      haveOldest = true;
+      oldestTs = ref.timestamp;
+      oldestBlockPos = ref.pos;
+    }
+    if (ref.timestamp <= startTs) {
+      haveStart = true;
+      startPos = ref.pos;
+    } else if (ref.timestamp > endTs) {
+      endPos = ref.pos;
+      break;
+    }
+  }
+  if (!haveOldest || endTs < oldestTs) {
+    return RECENT_TRACK_MISS; // 整段比环还老（或环内无可用段）
+  }
+  if (!haveStart) {
+    // 起点早于环覆盖范围：从最老可用块开始，前面的部分只在卡上
+    *outPos = oldestBlockPos;
+    *outEnd = endPos;
+    return RECENT_TRACK_PARTIAL;
+  }
+  *outPos = startPos;
+  *outEnd = endPos;
+  return RECENT_TRACK_OK;
+}
+
+bool recentTrackRead(uint32_t pos, uint8_t *dst, uint32_t len) {
+  uint32_t total = recentTotal;
+  if (len == 0 || pos + len > total) {
+    return false; // 越过已发布的数据
+  }
+  uint32_t r = pos % RECENT_RING_BYTES;
+  uint32_t tail = RECENT_RING_BYTES - r;
+  if (len <= tail) {
+    memcpy(dst, &recentRing[r], len);
+  } else {
+    memcpy(dst, &recentRing[r], tail);
+    memcpy(dst + tail, &recentRing[0], len - tail);
+  }
+  __DMB(); // 先拷贝完，再复验没被覆盖
+  return (recentTotal - pos) <= RECENT_RING_BYTES;
+}
+
 // Write GPS log data to the current daily file
-bool writeGpsLogDataToSD(const GpxPointInternal &entry) {
+bool writeGpsLogDataToSD(const GpxPointInternalV2 &entry) {
+    // SD 挂载在分级启动里延后到 loop 早期；极端情况下首个定位点
+    // 可能先于挂载到达，这里直接丢弃该点（10s 采样间隔，损失可忽略）
+    if (!sdFileSystemReady()) {
+        return false;
+    }
+
     // Ensure the correct file is open for the entry's timestamp
     if (!RotateSDLogFileIfNeeded(entry.timestamp)) {
         Log.println("Cannot write GPS data: Log file not ready");
         return false;
     }
     
-    auto len = gpsDataEncoder.encode(entry);
+    // 维护当前文件的时间范围（只改 RAM，轮换时才落到清单）
+    if (currentFileFirstTs == 0) {
+      currentFileFirstTs = entry.timestamp;
+    }
+    currentFileLastTs = entry.timestamp;
 
-    // 检查是否有足够空间在缓存中
-    if (cachePosition + len > sizeof(writeCache)) {
+    // 编码器直接写进写缓存，先确保有最大块的余量
+    if (cachePosition + GPZ_MAX_ENCODED_POINT_SIZE > sizeof(writeCache)) {
       // 缓存已满，先flush
       if (!flushCacheToSD()) {
         Log.println("Failed to flush cache before writing new data");
@@ -216,8 +612,24 @@ bool writeGpsLogDataToSD(const GpxPointInternal &entry) {
       }
     }
 
-    // 将数据写入缓存
-    memcpy(writeCache + cachePosition, gpsDataEncoder.getBuffer(), len);
+    // 流式编码：点直接序列化进缓存，无中间拷贝
+    uint32_t blockOffset = currentGpxFile.fileSize() + cachePosition;
+    auto len = gpsDataEncoder.encodeTo(entry, writeCache + cachePosition,
+                                       sizeof(writeCache) - cachePosition);
+    if (len == 0) {
+      Log.println("Failed to encode GPS point into write cache");
+      return false;
+    }
+    // 全量块（标记 0xFF/0xFE）进稀疏时间索引
+    uint8_t tag = writeCache[cachePosition];
+    if ((tag == 0xFF || tag == 0xFE) && timeIndexCount < TIME_INDEX_MAX_ENTRIES) {
+      timeIndex[timeIndexCount].timestamp = entry.timestamp;
+      timeIndex[timeIndexCount].offset = blockOffset;
+      timeIndexCount++;
+    }
+    // 同一份编码字节镜像进最近航迹 RAM 环（RECENT_TRACK 命令用）
+    recentTrackAppend(writeCache + cachePosition, len, entry.timestamp,
+                      tag == 0xFF || tag == 0xFE);
     cachePosition += len;
     cacheDirty = true;
 
@@ -230,9 +642,26 @@ bool writeGpsLogDataToSD(const GpxPointInternal &entry) {
 }
 
 // List SD card root directory contents
+// 日志文件直接列清单（免目录扫描）；清单没加载成功时退回老的
+// 逐项遍历
 void listSDRootContents() {
     Log.println("--- Listing SD Card Root Contents ---");
-    
+
+    if (logManifestLoaded && logManifestCount > 0) {
+        for (uint16_t i = 0; i < logManifestCount; i++) {
+            Log.printf("  FILE: %s\tSIZE: %lu bytes\t[%lu - %lu]\n",
+                       logManifest[i].name, logManifest[i].size,
+                       logManifest[i].firstTimestamp,
+                       logManifest[i].lastTimestamp);
+        }
+        // 当前打开的文件大小还没写回清单，单独补一行
+        if (isFileOpen && findManifestEntry(currentFilename) == nullptr) {
+            Log.printf("  FILE: %s\t(active)\n", currentFilename);
+        }
+        Log.println("-----------------------------------");
+        return;
+    }
+
     SdFile root;
     if (!root.open("/")) {
         Log.println("Failed to open root directory");
@@ -263,3 +692,92 @@ void listSDRootContents() {
     root.close();
     Log.println("-----------------------------------");
 }
+
+// 时间范围 → 字节范围。活动文件查 RAM 索引，已轮换文件读 .idx
+// 边车。起点取最后一个 ts <= startTs 的全量块（保证解码器能从
+// 范围开头建立差分状态），终点取第一个 ts > endTs 的全量块
+bool queryGpzTimeRange(const char *path, uint32_t startTs, uint32_t endTs,
+                       uint32_t *outOffset, uint32_t *outLength,
+                       uint32_t *outFileSize) {
+  const char *name = (path[0] == '/') ? path + 1 : path;
+
+  // 边车索引的载入缓冲。协议命令单线程处理，静态缓冲安全，
+  // 不占协议任务的栈
+  static TimeIndexEntry sidecar[TIME_INDEX_MAX_ENTRIES];
+  const TimeIndexEntry *idx = nullptr;
+  uint16_t idxCount = 0;
+  uint32_t fileSize = 0;
+
+  if (isFileOpen && strcmp(currentFilename, name) == 0) {
+    // 活动文件：先把写缓存落盘，返回的范围客户端才读得到
+    flushCacheToSD();
+    fileSize = currentGpxFile.fileSize();
+    idx = timeIndex;
+    idxCount = timeIndexCount;
+  } else {
+    SdFile f;
+    if (!f.open(name, O_READ)) {
+      return false;
+    }
+    fileSize = f.fileSize();
+    f.close();
+
+    char idxName[20];
+    SdFile fi;
+    if (idxPathFor(name, idxName, sizeof(idxName)) &&
+        fi.open(idxName, O_READ)) {
+      uint32_t magic = 0;
+      uint16_t count = 0;
+      if (fi.read(&magic, 4) == 4 && magic == TIME_INDEX_MAGIC &&
+          fi.read(&count, 2) == 2 && count <= TIME_INDEX_MAX_ENTRIES) {
+        int expected = (int)(sizeof(TimeIndexEntry) * count);
+        if (fi.read(sidecar, expected) == expected) {
+          idx = sidecar;
+          idxCount = count;
+        }
+      }
+      fi.close();
+    }
+    // 没有边车索引：退化为整文件（文件以全量块开头，解码仍正确）
+  }
+
+  uint32_t begin = 0;
+  uint32_t end = fileSize;
+  if (idx != nullptr && idxCount > 0) {
+    // 最后一个 timestamp <= startTs 的条目
+    int lo = 0, hi = (int)idxCount - 1, found = -1;
+    while (lo <= hi) {
+      int mid = (lo + hi) / 2;
+      if (idx[mid].timestamp <= startTs) {
+        found = mid;
+        lo = mid + 1;
+      } else {
+        hi = mid - 1;
+      }
+    }
+    if (found >= 0) {
+      begin = idx[found].offset;
+    }
+    // 第一个 timestamp > endTs 的条目
+    lo = 0;
+    hi = (int)idxCount - 1;
+    found = -1;
+    while (lo <= hi) {
+      int mid = (lo + hi) / 2;
+      if (idx[mid].timestamp > endTs) {
+        found = mid;
+        hi = mid - 1;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    if (found >= 0 && idx[found].offset >= begin) {
+      end = idx[found].offset;
+    }
+  }
+
+  *outOffset = begin;
+  *outLength = (end > begin) ? (end - begin) : 0;
+  *outFileSize = fileSize;
+  return true;
+}
@@ -7,9 +7,9 @@
 // 初始化 SD 卡用于 GPS 日志记录
 bool initSDForGPSLogging();
 
-// 将准备好的 GpxPointInternal (二进制结构) 写入当天的日志文件
-// 写入前会检查日期变化和管理旧文件
-bool writeGpsLogDataToSD(const GpxPointInternal &entry);
+// 将准备好的 GpxPointInternalV2 (二进制结构, 1e7 精度) 写入当天的
+// 日志文件。写入前会检查日期变化和管理旧文件
+bool writeGpsLogDataToSD(const GpxPointInternalV2 &entry);
 
 // 检查日期变化并轮换日志文件
 bool RotateSDLogFileIfNeeded(uint32_t timestamp);
@@ -23,7 +23,40 @@ void manageOldSDFiles();
 // 立即将缓存数据写入SD卡
 bool flushCacheToSD();
 
+// 空闲钩子：缓存到达水位后冲刷扇区对齐的部分（在 loop 空闲段调用）
+bool serviceSDCacheFlush();
+
+// 空闲钩子：分摊删除已入队的过期日志文件，一次最多删一个
+bool serviceSDMaintenance();
+
 // 获取缓存使用情况
 std::size_t getCacheUsage();
 
+// 时间范围 → 字节范围解析（READ_TIME_RANGE 命令用）。
+// 基于稀疏时间索引（每个全量块的时间戳 + 文件偏移；活动文件在
+// RAM，轮换时写 .idx 边车文件）。返回的字节范围保证以全量块开头，
+// 覆盖 [startTs, endTs] 内的所有点。没有索引时退化为整文件。
+// 返回 false 表示文件不存在
+bool queryGpzTimeRange(const char *path, uint32_t startTs, uint32_t endTs,
+                       uint32_t *outOffset, uint32_t *outLength,
+                       uint32_t *outFileSize);
+
+// --- 最近航迹 RAM 环（RECENT_TRACK 命令后端，零 SD I/O） ---
+// 日志路径把每个编码点同时镜像进一个几 KB 的 RAM 环。
+// 解析/读取是无锁的（拷贝后复验），可以从 BLE 任务安全调用
+
+// recentTrackResolve 的返回码
+#define RECENT_TRACK_OK 0      // 环完整覆盖请求的时间段
+#define RECENT_TRACK_PARTIAL 1 // 起点早于环覆盖范围，更老的部分只在卡上
+#define RECENT_TRACK_MISS 2    // 环里没有该时间段的数据（走 SD 路径）
+
+// 把 [startTs, endTs]（endTs=0 表示到当前）解析成环内逻辑字节
+// 区间 [*outPos, *outEnd)，保证以全量块开头
+uint8_t recentTrackResolve(uint32_t startTs, uint32_t endTs, uint32_t *outPos,
+                           uint32_t *outEnd);
+
+// 从逻辑位置拷贝 len 字节；返回 false 表示该区间已被环覆盖
+// （或越过已发布的数据），调用方应重新解析
+bool recentTrackRead(uint32_t pos, uint8_t *dst, uint32_t len);
+
 #endif // SD_HANDLER_H
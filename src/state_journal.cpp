@@ -0,0 +1,178 @@
+#include "state_journal.h"
+#include "Adafruit_LittleFS.h"
+#include "InternalFileSystem.h"
+#include "crc32.h"
+#include "logger.h"
+#include <Arduino.h>
+#include <string.h>
+
+using namespace Adafruit_LittleFS_Namespace;
+
+#define JOURNAL_PATH "/state.jnl"
+#define JOURNAL_TMP_PATH "/state.jnl.tmp"
+#define JOURNAL_MAGIC 0xA5
+#define JOURNAL_RECORD_SIZE 24
+// 压实阈值：约 170 条记录。LittleFS 块 4K，让日志多占一两个块
+// 换来追加写，擦除次数远低于整文件重写
+#define JOURNAL_COMPACT_BYTES 4096
+
+struct __attribute__((packed)) JournalRecord {
+  uint8_t magic;
+  uint8_t type;
+  uint8_t reserved[2];
+  uint8_t payload[JOURNAL_RECORD_PAYLOAD];
+  uint32_t crc;
+};
+
+static_assert(sizeof(JournalRecord) == JOURNAL_RECORD_SIZE,
+              "journal record layout");
+
+// 内存索引：每个类型的最新 payload。读路径不碰文件系统
+static uint8_t journalIndex[JOURNAL_TYPE_MAX][JOURNAL_RECORD_PAYLOAD];
+static bool journalIndexValid[JOURNAL_TYPE_MAX];
+static uint32_t journalFileBytes = 0;
+static bool journalReady = false;
+
+static uint32_t recordCrc(const JournalRecord &rec) {
+  return crc32_calc(&rec, JOURNAL_RECORD_SIZE - 4);
+}
+
+static bool appendRecord(const JournalRecord &rec) {
+  File f(InternalFS);
+  if (!f.open(JOURNAL_PATH, FILE_O_WRITE)) { // FILE_O_WRITE 为追加模式
+    Log.println("Journal: append open failed");
+    return false;
+  }
+  size_t written = f.write((const uint8_t *)&rec, JOURNAL_RECORD_SIZE);
+  f.close();
+  if (written != JOURNAL_RECORD_SIZE) {
+    Log.printf("Journal: short append (%d)\n", (int)written);
+    return false;
+  }
+  journalFileBytes += JOURNAL_RECORD_SIZE;
+  return true;
+}
+
+// 压实：每个在用类型只留最新一条，先写临时文件再原子换名。
+// 换名前断电最坏丢掉这次压实，旧文件仍完整
+static void compactJournal() {
+  File f(InternalFS);
+  InternalFS.remove(JOURNAL_TMP_PATH);
+  if (!f.open(JOURNAL_TMP_PATH, FILE_O_WRITE)) {
+    Log.println("Journal: compact open failed");
+    return;
+  }
+  for (uint8_t t = 0; t < JOURNAL_TYPE_MAX; t++) {
+    if (!journalIndexValid[t]) {
+      continue;
+    }
+    JournalRecord rec;
+    rec.magic = JOURNAL_MAGIC;
+    rec.type = t;
+    rec.reserved[0] = rec.reserved[1] = 0;
+    memcpy(rec.payload, journalIndex[t], JOURNAL_RECORD_PAYLOAD);
+    rec.crc = recordCrc(rec);
+    if (f.write((const uint8_t *)&rec, JOURNAL_RECORD_SIZE) !=
+        JOURNAL_RECORD_SIZE) {
+      Log.println("Journal: compact write failed");
+      f.close();
+      InternalFS.remove(JOURNAL_TMP_PATH);
+      return;
+    }
+  }
+  uint32_t newSize = f.size();
+  f.close();
+  InternalFS.remove(JOURNAL_PATH);
+  if (!InternalFS.rename(JOURNAL_TMP_PATH, JOURNAL_PATH)) {
+    Log.println("Journal: compact rename failed");
+    return;
+  }
+  journalFileBytes = newSize;
+  Log.printf("Journal: compacted to %lu bytes\n", (unsigned long)newSize);
+}
+
+bool initStateJournal() {
+  memset(journalIndexValid, 0, sizeof(journalIndexValid));
+  journalFileBytes = 0;
+  journalReady = false;
+
+  File f(InternalFS);
+  if (!f.open(JOURNAL_PATH, FILE_O_READ)) {
+    // 还没有日志文件，首次写入时创建
+    journalReady = true;
+    Log.println("Journal: no existing file, starting fresh");
+    return true;
+  }
+
+  JournalRecord rec;
+  uint32_t good = 0;
+  while (f.read((uint8_t *)&rec, JOURNAL_RECORD_SIZE) == JOURNAL_RECORD_SIZE) {
+    if (rec.magic != JOURNAL_MAGIC || rec.type >= JOURNAL_TYPE_MAX ||
+        rec.crc != recordCrc(rec)) {
+      // 坏记录：尾部视为脏数据，停止扫描（压实时清掉）
+      Log.println("Journal: bad record, truncating scan");
+      break;
+    }
+    memcpy(journalIndex[rec.type], rec.payload, JOURNAL_RECORD_PAYLOAD);
+    journalIndexValid[rec.type] = true;
+    good++;
+  }
+  journalFileBytes = f.size();
+  f.close();
+  journalReady = true;
+  Log.printf("Journal: %lu records scanned, %lu bytes\n", (unsigned long)good,
+             (unsigned long)journalFileBytes);
+
+  // 启动即超阈值就顺手压实（扫描刚建好索引，正是时候）
+  if (journalFileBytes >= JOURNAL_COMPACT_BYTES) {
+    compactJournal();
+  }
+  return true;
+}
+
+bool journalWrite(uint8_t type, const void *payload, size_t len) {
+  if (!journalReady || type >= JOURNAL_TYPE_MAX ||
+      len > JOURNAL_RECORD_PAYLOAD || (payload == nullptr && len > 0)) {
+    return false;
+  }
+
+  JournalRecord rec;
+  rec.magic = JOURNAL_MAGIC;
+  rec.type = type;
+  rec.reserved[0] = rec.reserved[1] = 0;
+  memset(rec.payload, 0, JOURNAL_RECORD_PAYLOAD);
+  if (len > 0) {
+    memcpy(rec.payload, payload, len);
+  }
+
+  // 值没变就不写——高频调用方（状态机转换）不用自己做去重
+  if (journalIndexValid[type] &&
+      memcmp(journalIndex[type], rec.payload, JOURNAL_RECORD_PAYLOAD) == 0) {
+    return true;
+  }
+
+  rec.crc = recordCrc(rec);
+  if (!appendRecord(rec)) {
+    return false;
+  }
+  memcpy(journalIndex[type], rec.payload, JOURNAL_RECORD_PAYLOAD);
+  journalIndexValid[type] = true;
+
+  if (journalFileBytes >= JOURNAL_COMPACT_BYTES) {
+    compactJournal();
+  }
+  return true;
+}
+
+bool journalRead(uint8_t type, void *payload, size_t len) {
+  if (type >= JOURNAL_TYPE_MAX || !journalIndexValid[type] ||
+      payload == nullptr || len > JOURNAL_RECORD_PAYLOAD) {
+    return false;
+  }
+  memcpy(payload, journalIndex[type], len);
+  return true;
+}
+
+bool journalHas(uint8_t type) {
+  return type < JOURNAL_TYPE_MAX && journalIndexValid[type];
+}
@@ -0,0 +1,44 @@
+#ifndef STATE_JOURNAL_H
+#define STATE_JOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 内部闪存上的追加式状态日志（journal）。
+//
+// 设备的小状态（状态机模式、A-GNSS 新鲜度时间戳、日志轮转记账）
+// 更新很频繁，若每次都整文件重写，LittleFS 的拷贝写放大可观，而且
+// 每次擦除都会卡住 loop 几毫秒。这里改成：定长带 CRC 的类型化记录
+// 追加到一个日志文件尾部，同类型后写覆盖先写；启动时扫一遍文件建
+// 内存索引，之后读取是纯 RAM 查表，写入是一次小追加。文件长到阈值
+// 后压实：每个在用类型只留最新一条，重建文件。
+//
+// 记录格式（24 字节定长）：
+//   [magic:1=0xA5][type:1][rsv:2][payload:16][crc32:4]
+// crc32 覆盖前 20 字节。扫描遇到坏记录即停（尾部视为脏数据，
+// 下次压实清掉）。
+
+#define JOURNAL_RECORD_PAYLOAD 16
+#define JOURNAL_TYPE_MAX 8 // 内存索引槽位数（type 取值 0..7）
+
+// 在用的记录类型
+enum JournalRecordType : uint8_t {
+  JOURNAL_LAST_GPS_STATE = 0, // payload[0] = GpsState_t
+  JOURNAL_AGNSS_FRESHNESS = 1, // payload[0..3] = 注入完成时的 Unix 时间戳
+  JOURNAL_LAST_FIX = 2, // lat_1e7:i32 lon_1e7:i32 alt_cm:i32 ts:u32
+  JOURNAL_LOG_ROTATION = 3, // 日志轮转记账（预留）
+};
+
+// 挂载后调用：扫描日志文件，重建内存索引
+bool initStateJournal();
+
+// 追加一条记录（len ≤ 16，不足补零）。同类型的旧记录自动被视为过期
+bool journalWrite(uint8_t type, const void *payload, size_t len);
+
+// O(1) 读内存索引里该类型的最新 payload。没有记录返回 false
+bool journalRead(uint8_t type, void *payload, size_t len);
+
+// 该类型是否有记录
+bool journalHas(uint8_t type);
+
+#endif // STATE_JOURNAL_H
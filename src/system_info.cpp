@@ -0,0 +1,55 @@
+#include "system_info.h"
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <string.h>
+
+// gSystemInfo 的无锁快照发布（双缓冲 + 序号）。
+//
+// gSystemInfo 本体仍是写方的工作副本：GPS 处理（loop 任务）和电池
+// 定时器（timer 任务）照旧逐字段写，写完一组相关字段后调
+// publishSystemInfo() 把整个结构体拷进当前非活动的缓冲、再翻序号。
+// 读方（显示刷新在 timer 任务、协议响应在 BLE 路径）用
+// systemInfoSnapshot() 拿一份整体一致的快照——以前直接读全局，
+// 可能撞上写了一半的 lat/lon 对。
+//
+// 读侧完全无锁也不关中断：读完后校验序号，只有在拷贝期间发生了
+// 两次以上发布（说明自己读的那个缓冲被重写）才重试。发布最快
+// 也就几十 Hz，拷贝是微秒级，重试在实际运行中不会发生。
+// 写侧用互斥量串行化（发布方都在任务上下文）；将来如果出现 ISR
+// 生产者，它不能拿互斥量，需要改成关中断的短临界区来串行发布。
+
+static SystemInfo snapshotBuf[2];
+static volatile uint32_t snapshotSeq = 0; // 低位选当前稳定副本
+
+static SemaphoreHandle_t publish_mutex = NULL;
+
+static void publish_lock_init() {
+  if (publish_mutex == NULL) {
+    publish_mutex = xSemaphoreCreateMutex();
+  }
+}
+
+void publishSystemInfo() {
+  publish_lock_init();
+  xSemaphoreTake(publish_mutex, portMAX_DELAY);
+  uint32_t seq = snapshotSeq;
+  snapshotBuf[(seq + 1) & 1] = gSystemInfo;
+  __DMB(); // 数据先落地，序号才翻
+  snapshotSeq = seq + 1;
+  xSemaphoreGive(publish_mutex);
+}
+
+void systemInfoSnapshot(SystemInfo &out) {
+  for (uint8_t attempt = 0; attempt < 4; attempt++) {
+    uint32_t seqBefore = snapshotSeq;
+    __DMB();
+    out = snapshotBuf[seqBefore & 1];
+    __DMB();
+    // 序号只前进了一格说明写方在填另一个缓冲，读到的副本仍完整
+    if (snapshotSeq - seqBefore < 2) {
+      return;
+    }
+  }
+  // 连续撞上发布（理论上到不了这里），保留最后一次读到的内容，
+  // 最坏旧一代
+}
@@ -17,6 +17,12 @@ typedef enum {
 // Structure to hold all system information
 struct SystemInfo {
   // GPS Data - Using numerical types now
+  // 定点整数是权威值（M4F 没有双精度 FPU，double 全走软浮点；
+  // 采样热路径只碰这几个整数）。double/float 视图仅供显示和
+  // 既有协议字段使用，由整数换算得到。
+  int32_t latitude_scaled_1e7 = 0;  // 纬度 (度 * 10^7)
+  int32_t longitude_scaled_1e7 = 0; // 经度 (度 * 10^7)
+  int32_t altitude_cm = 0;          // 海拔 (厘米)
   double latitude = 0.0;
   double longitude = 0.0;
   float altitude = 0.0f; // Meters
@@ -47,4 +53,12 @@ extern SystemInfo gSystemInfo;
 // Function declarations
 void initializeSystemInfo();
 
+// --- 无锁快照（system_info.cpp）---
+// gSystemInfo 是写方的工作副本，跨上下文的读方不要直接读它：
+// 写方完成一组相关字段后调 publishSystemInfo() 发布，读方用
+// systemInfoSnapshot() 拿整体一致的拷贝（双缓冲 + 序号校验，
+// 不加锁也不关中断）
+void publishSystemInfo();
+void systemInfoSnapshot(SystemInfo &out);
+
 #endif // SYSTEM_INFO_H
@@ -0,0 +1,42 @@
+#include "track_simplifier.h"
+#include <math.h>
+
+// 1 度纬度 ≈ 111320 m → 1 m ≈ 89.83 个 1e7 单位
+static const float UNITS_PER_METER = 1e7f / 111320.0f;
+
+TrackSimplifier::TrackSimplifier()
+    : epsilonUnitsSq_(0.0f), lonScale_(1.0f), hasKept_(false), keptLat_(0),
+      keptLon_(0) {}
+
+void TrackSimplifier::reset(uint16_t epsilon_m) {
+  float units = (float)epsilon_m * UNITS_PER_METER;
+  epsilonUnitsSq_ = units * units;
+  lonScale_ = 1.0f;
+  hasKept_ = false;
+}
+
+void TrackSimplifier::widenEpsilon(uint16_t epsilon_m) {
+  float units = (float)epsilon_m * UNITS_PER_METER;
+  epsilonUnitsSq_ = units * units;
+}
+
+bool TrackSimplifier::offer(const GpxPointInternalV2 &point) {
+  if (!hasKept_) {
+    // 首点：保留并确定经度的 cos 校正系数
+    lonScale_ = cosf((float)point.latitude_scaled_1e7 * 1e-7f *
+                     (3.14159265f / 180.0f));
+    hasKept_ = true;
+    keptLat_ = point.latitude_scaled_1e7;
+    keptLon_ = point.longitude_scaled_1e7;
+    return true;
+  }
+
+  float dLat = (float)(point.latitude_scaled_1e7 - keptLat_);
+  float dLon = (float)(point.longitude_scaled_1e7 - keptLon_) * lonScale_;
+  if (dLat * dLat + dLon * dLon < epsilonUnitsSq_) {
+    return false;
+  }
+  keptLat_ = point.latitude_scaled_1e7;
+  keptLon_ = point.longitude_scaled_1e7;
+  return true;
+}
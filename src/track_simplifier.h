@@ -0,0 +1,34 @@
+#ifndef TRACK_SIMPLIFIER_H
+#define TRACK_SIMPLIFIER_H
+
+#include "gps_data_encoder.h" // GpxPointInternalV2
+#include <stdint.h>
+
+// 流式航迹抽稀器（径向距离法）：单遍扫描，每个点只和上一个保留点
+// 比距离，超过 epsilon 才保留。不像 Douglas-Peucker 需要整条航迹
+// 在内存里，适合边解码边抽稀的预览下载路径。
+// 本文件不依赖 Arduino，可在宿主机上编译（测试/基准用）。
+class TrackSimplifier {
+public:
+  TrackSimplifier();
+
+  // 开始新航迹，epsilon 单位米。首个 offer 的点总是保留
+  void reset(uint16_t epsilon_m);
+
+  // 喂入一个点，返回 true 表示该点应当保留。
+  // 经度按首点纬度做 cos 校正后参与距离计算
+  bool offer(const GpxPointInternalV2 &point);
+
+  // 运行中调大 epsilon（点数超限时由调用方翻倍后继续）
+  void widenEpsilon(uint16_t epsilon_m);
+
+private:
+  // 1e-7 度纬度 ≈ 1.11 cm；epsilon 换算成 1e7 单位存平方比较
+  float epsilonUnitsSq_;
+  float lonScale_; // cos(首点纬度)
+  bool hasKept_;
+  int32_t keptLat_;
+  int32_t keptLon_;
+};
+
+#endif // TRACK_SIMPLIFIER_H
@@ -0,0 +1,26 @@
+#pragma once
+
+// env:native 的最小 Arduino 兼容层。只覆盖被测纯逻辑源文件
+// （casic_gps_wrapper / gps_data_encoder / gps_data_decoder /
+// accel_analyzer / log_ring）间接用到的符号，不是通用 Arduino 桩：
+// 新增被测文件如果缺符号，在这里按需补，不要把整个核搬进来。
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 宿主机单调毫秒（test/test_native/native_stubs.cpp 用 chrono 实现）
+unsigned long millis();
+
+// logger.h 只拿它存指针、判在线、打印；宿主机上永远"不在线"，
+// 所有输出路径短路
+class Adafruit_USBD_CDC {
+public:
+  template <typename T> void print(const T &) {}
+  template <typename T> void println(const T &) {}
+  void print(const char *) {}
+  void println(const char *) {}
+  explicit operator bool() const { return false; }
+};
@@ -0,0 +1,3 @@
+#pragma once
+// env:native 桩：宿主机测试是单线程的，FreeRTOS 原语全部空实现
+// （类型定义见 semphr.h）
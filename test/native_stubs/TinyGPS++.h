@@ -0,0 +1,17 @@
+#pragma once
+#include <stddef.h> // 真库经由 Arduino.h 带出 size_t，桩里显式补上
+#include <stdint.h>
+
+// env:native 桩：CasicGpsWrapper 只要求 encode() 吞掉非 CASIC 字节。
+// 记录穿透的字符数和最后一个字符，测试据此断言 NMEA 旁路行为；
+// 真正的 NMEA 解析属于第三方库，不在宿主机测试范围内
+class TinyGPSPlus {
+public:
+  bool encode(char c) {
+    passthroughCount++;
+    lastChar = c;
+    return false;
+  }
+  uint32_t passthroughCount = 0;
+  char lastChar = 0;
+};
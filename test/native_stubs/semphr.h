@@ -0,0 +1,3 @@
+#pragma once
+// env:native 桩：logger.h 只需要句柄类型能声明成员变量
+typedef void *SemaphoreHandle_t;
@@ -0,0 +1,29 @@
+// env:native 的链接桩：logger.cpp 依赖 USB CDC 和 FreeRTOS，
+// 不参与宿主机构建，这里给被测文件引用到的 Logger 符号提供
+// 空实现（serial_ 置空，所有打印路径短路）。millis() 用 chrono。
+
+#include "logger.h"
+#include <chrono>
+
+unsigned long millis() {
+  using namespace std::chrono;
+  static const steady_clock::time_point t0 = steady_clock::now();
+  return (unsigned long)duration_cast<milliseconds>(steady_clock::now() - t0)
+      .count();
+}
+
+Logger::Logger(Adafruit_USBD_CDC &serial, long baudRate)
+    : serial_(nullptr), baudRate_(baudRate), enabled_(false) {
+  (void)serial;
+}
+
+void Logger::begin() {}
+void Logger::setEnabled(bool enabled) { (void)enabled; }
+bool Logger::isEnabled() { return false; }
+void Logger::lock() {}
+void Logger::unlock() {}
+void Logger::drainDeferred() {}
+void serviceLogDrain() {}
+
+static Adafruit_USBD_CDC stubSerial;
+Logger Log(stubSerial, 115200);
@@ -0,0 +1,375 @@
+// 宿主机单元测试 + 吞吐基准（pio test -e native）。
+//
+// 覆盖三块可以脱离硬件跑的热路径逻辑：
+//   - CasicGpsWrapper：CASIC 帧状态机（逐字节 / 整帧两条路径）、
+//     校验和拒收、错包后重同步、NMEA 旁路
+//   - GpsDataEncoder/Decoder：合成航迹往返一致性、全量块节奏
+//     （体积/参数实验另见 bench/，两边共用同一批源文件）
+//   - AccelAnalyzer：静止/跳变判定、方差
+// 每组最后附一个吞吐报告（信息性输出，不设阈值断言——宿主机
+// 速度只用来对比改动前后的相对变化，不代表真机）。
+//
+// CASIC 回放帧用 casic_frame.h 的组帧器构造，和 casic_parser.py
+// 解析的抓包是同一种线格式；有实采数据时可以直接把字节流喂进
+// feedBytes() 回放。
+
+#include "accel_analyzer.h"
+#include "casic_frame.h"
+#include "casic_gps_wrapper.h"
+#include "gps_data_decoder.h"
+#include "gps_data_encoder.h"
+#include "mem_arena.h"
+
+#include <unity.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+void setUp() {}
+void tearDown() {}
+
+// ---------- CASIC 解析 ----------
+
+static uint16_t makeTestFrame(uint8_t cls, uint8_t id, const uint8_t *payload,
+                              uint16_t len, uint8_t *out, uint16_t cap) {
+  return casic::buildFrame(cls, id, payload, len, out, cap);
+}
+
+static bool feedBytes(CasicGpsWrapper &w, const uint8_t *data, size_t len) {
+  bool completed = false;
+  for (size_t i = 0; i < len; i++) {
+    if (w.encode(data[i])) {
+      completed = true;
+    }
+  }
+  return completed;
+}
+
+static void test_casic_parses_valid_frame() {
+  CasicGpsWrapper w;
+  // CASIC 载荷长度总是 4 的倍数（校验和按 32 位字累加）
+  const uint8_t payload[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+  uint8_t frame[32];
+  uint16_t n = makeTestFrame(0x0B, 0x01, payload, sizeof(payload), frame,
+                             sizeof(frame));
+  TEST_ASSERT_EQUAL_UINT16(casic::frameSize(sizeof(payload)), n);
+
+  TEST_ASSERT_TRUE(feedBytes(w, frame, n));
+  TEST_ASSERT_TRUE(w.isNewCasicData());
+  CasicPacket p = w.getLastCasicPacket();
+  TEST_ASSERT_TRUE(p.valid);
+  TEST_ASSERT_EQUAL_UINT8(0x0B, p.class_id);
+  TEST_ASSERT_EQUAL_UINT8(0x01, p.msg_id);
+  TEST_ASSERT_EQUAL_UINT16(sizeof(payload), p.payload_length);
+  TEST_ASSERT_EQUAL_MEMORY(payload, p.payload, sizeof(payload));
+}
+
+static void test_casic_rejects_bad_checksum_and_recovers() {
+  CasicGpsWrapper w;
+  const uint8_t payload[] = {0xAA, 0xBB, 0xCC, 0xDD};
+  uint8_t frame[32];
+  uint16_t n = makeTestFrame(0x08, 0x07, payload, sizeof(payload), frame,
+                             sizeof(frame));
+
+  uint8_t corrupted[32];
+  memcpy(corrupted, frame, n);
+  corrupted[n - 1] ^= 0xFF; // 校验和最后一个字节打翻
+  // 逐字节路径"帧收完"就返回 true，有效性看 isNewCasicData
+  TEST_ASSERT_TRUE(feedBytes(w, corrupted, n));
+  TEST_ASSERT_FALSE(w.isNewCasicData());
+
+  // 错包之后状态机要能回到空闲并吃下后续的好帧
+  TEST_ASSERT_TRUE(feedBytes(w, frame, n));
+  TEST_ASSERT_TRUE(w.isNewCasicData());
+  TEST_ASSERT_TRUE(w.getLastCasicPacket().valid);
+}
+
+static void test_casic_resync_after_noise() {
+  CasicGpsWrapper w;
+  // 含 0xBA 的噪声：解析器会误入头部状态，必须能退出来
+  const uint8_t noise[] = {0x00, 0xBA, 0x12, 0xBA, 0xBA, 0x34};
+  feedBytes(w, noise, sizeof(noise));
+
+  const uint8_t payload[] = {0x10, 0x20, 0x30, 0x40};
+  uint8_t frame[32];
+  uint16_t n = makeTestFrame(0x05, 0x01, payload, sizeof(payload), frame,
+                             sizeof(frame));
+  TEST_ASSERT_TRUE(feedBytes(w, frame, n));
+  TEST_ASSERT_TRUE(w.getLastCasicPacket().valid);
+}
+
+static void test_casic_process_buffer_matches_byte_path() {
+  const uint8_t payload[] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+  uint8_t frame[32];
+  uint16_t n = makeTestFrame(0x08, 0x02, payload, sizeof(payload), frame,
+                             sizeof(frame));
+
+  CasicGpsWrapper byByte, byBuffer;
+  feedBytes(byByte, frame, n);
+  TEST_ASSERT_TRUE(byBuffer.processBuffer(frame, n));
+
+  CasicPacket a = byByte.getLastCasicPacket();
+  CasicPacket b = byBuffer.getLastCasicPacket();
+  TEST_ASSERT_EQUAL_UINT8(a.class_id, b.class_id);
+  TEST_ASSERT_EQUAL_UINT8(a.msg_id, b.msg_id);
+  TEST_ASSERT_EQUAL_UINT16(a.payload_length, b.payload_length);
+  TEST_ASSERT_EQUAL_MEMORY(a.payload, b.payload, a.payload_length);
+
+  // 坏校验和整帧路径也要拒收
+  frame[n - 2] ^= 0x01;
+  TEST_ASSERT_FALSE(byBuffer.processBuffer(frame, n));
+}
+
+static void test_casic_nmea_passthrough() {
+  CasicGpsWrapper w;
+  const char *nmea = "$GNGGA,060000.00,3136.00,N,12018.00,E,1,08,1.0,15.0,M*00\r\n";
+  for (const char *c = nmea; *c; c++) {
+    w.encode((uint8_t)*c);
+  }
+  // 非 CASIC 字节逐个穿透给 TinyGPS++（桩只计数）
+  TEST_ASSERT_EQUAL_UINT32((uint32_t)strlen(nmea),
+                           w.getTinyGPS().passthroughCount);
+  TEST_ASSERT_FALSE(w.isNewCasicData());
+}
+
+// ---------- GPZ 编码/解码 ----------
+
+// 合成航迹（确定性，种子固定），与 bench/bench.cpp 的生成器同构
+static std::vector<GpxPointInternalV2> makeTrack(size_t count,
+                                                 int32_t step_1e7) {
+  std::vector<GpxPointInternalV2> track;
+  track.reserve(count);
+  uint32_t rng = 0x12345678;
+  GpxPointInternalV2 p;
+  p.timestamp = 1700000000u;
+  p.latitude_scaled_1e7 = 316000000;
+  p.longitude_scaled_1e7 = 1203000000;
+  p.altitude_m_scaled_1e1 = 150;
+  for (size_t i = 0; i < count; i++) {
+    track.push_back(p);
+    rng = rng * 1664525u + 1013904223u;
+    p.timestamp += 10;
+    p.latitude_scaled_1e7 += step_1e7 + (int32_t)(rng % 21) - 10;
+    p.longitude_scaled_1e7 += (step_1e7 * 2) / 3 + (int32_t)((rng >> 8) % 21) - 10;
+    p.altitude_m_scaled_1e1 += (int32_t)((rng >> 16) % 5) - 2;
+  }
+  return track;
+}
+
+static void roundtrip(const std::vector<GpxPointInternalV2> &track,
+                      int32_t lat_lon_tolerance_1e7, size_t *fullBlocks) {
+  std::vector<uint8_t> encoded(track.size() * GPZ_MAX_ENCODED_POINT_SIZE);
+  GpsDataEncoder encoder(64);
+  size_t total = 0;
+  for (size_t i = 0; i < track.size(); i++) {
+    uint32_t n =
+        encoder.encodeTo(track[i], &encoded[total], encoded.size() - total);
+    TEST_ASSERT_NOT_EQUAL_UINT32(0, n);
+    total += n;
+  }
+
+  GpsDataDecoder decoder;
+  size_t pos = 0, blocks = 0;
+  if (fullBlocks) {
+    *fullBlocks = 0;
+  }
+  for (size_t i = 0; i < track.size(); i++) {
+    if (fullBlocks && (encoded[pos] == 0xFF || encoded[pos] == 0xFE)) {
+      (*fullBlocks)++;
+    }
+    GpxPointInternalV2 out;
+    uint32_t consumed = decoder.decodeNext(&encoded[pos], total - pos, &out);
+    TEST_ASSERT_NOT_EQUAL_UINT32(0, consumed);
+    pos += consumed;
+    blocks++;
+
+    TEST_ASSERT_EQUAL_UINT32(track[i].timestamp, out.timestamp);
+    TEST_ASSERT_EQUAL_INT32(track[i].altitude_m_scaled_1e1,
+                            out.altitude_m_scaled_1e1);
+    TEST_ASSERT_INT32_WITHIN(lat_lon_tolerance_1e7,
+                             track[i].latitude_scaled_1e7,
+                             out.latitude_scaled_1e7);
+    TEST_ASSERT_INT32_WITHIN(lat_lon_tolerance_1e7,
+                             track[i].longitude_scaled_1e7,
+                             out.longitude_scaled_1e7);
+  }
+  TEST_ASSERT_EQUAL_size_t(track.size(), blocks);
+  TEST_ASSERT_EQUAL_size_t(total, pos); // 流正好消费完
+}
+
+static void test_gpz_roundtrip_walking() {
+  // 步行步长（~3m/样本）落入 V1 段：经纬度量化到 1e5，
+  // 误差上限 50 个 1e7 单位（四舍五入半步）
+  roundtrip(makeTrack(500, 300), 50, nullptr);
+}
+
+static void test_gpz_roundtrip_stationary_exact() {
+  // 静止微抖动落入 V2 段：1e7 全精度，必须逐位精确
+  roundtrip(makeTrack(500, 0), 0, nullptr);
+}
+
+static void test_gpz_full_block_cadence() {
+  // 64 点一个全量块：130 个点 → 3 个全量块（0 / 64 / 128）
+  size_t fullBlocks = 0;
+  roundtrip(makeTrack(130, 0), 0, &fullBlocks);
+  TEST_ASSERT_EQUAL_size_t(3, fullBlocks);
+}
+
+// ---------- 加速度分析器 ----------
+
+static void test_accel_still_then_jump() {
+  AccelAnalyzer analyzer(256, 0.1f, 2.0f); // main.cpp 的参数
+  uint32_t rng = 7;
+  for (int i = 0; i < 300; i++) {
+    rng = rng * 1664525u + 1013904223u;
+    analyzer.addSample(1.0f + ((int32_t)(rng % 11) - 5) * 0.002f); // ±0.01g
+  }
+  TEST_ASSERT_TRUE(analyzer.isStill());
+  TEST_ASSERT_FALSE(analyzer.hasJump());
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, analyzer.variance());
+
+  analyzer.addSample(3.5f); // 拎起来甩了一下
+  TEST_ASSERT_TRUE(analyzer.hasJump());
+  TEST_ASSERT_FALSE(analyzer.isStill());
+}
+
+static void test_accel_motion_not_still() {
+  AccelAnalyzer analyzer(256, 0.1f, 2.0f);
+  uint32_t rng = 99;
+  for (int i = 0; i < 300; i++) {
+    rng = rng * 1664525u + 1013904223u;
+    analyzer.addSample(1.0f + ((int32_t)(rng % 61) - 30) * 0.01f); // ±0.3g
+  }
+  TEST_ASSERT_FALSE(analyzer.isStill());
+}
+
+static void test_accel_window_slides_back_to_still() {
+  // 跳变样本滑出 256 点窗口后要能重新判静止
+  AccelAnalyzer analyzer(256, 0.1f, 2.0f);
+  analyzer.addSample(3.5f);
+  for (int i = 0; i < 256; i++) {
+    analyzer.addSample(1.0f);
+  }
+  TEST_ASSERT_TRUE(analyzer.isStill());
+}
+
+// ---------- 吞吐报告（信息性，不断言阈值） ----------
+
+static double secondsSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+      .count();
+}
+
+static void test_throughput_report() {
+  char msg[128];
+
+  { // CASIC 逐字节 vs 整帧
+    uint8_t payload[64];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+      payload[i] = (uint8_t)i;
+    }
+    uint8_t frame[80];
+    uint16_t n =
+        makeTestFrame(0x08, 0x07, payload, sizeof(payload), frame, sizeof(frame));
+    const int reps = 20000;
+
+    CasicGpsWrapper w;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++) {
+      TEST_ASSERT_TRUE(feedBytes(w, frame, n));
+    }
+    double byByte = (double)reps * n / secondsSince(t0) / 1e6;
+
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++) {
+      TEST_ASSERT_TRUE(w.processBuffer(frame, n));
+    }
+    double byBuffer = (double)reps * n / secondsSince(t0) / 1e6;
+    snprintf(msg, sizeof(msg), "CASIC: %.1f MB/s byte-wise, %.1f MB/s batch",
+             byByte, byBuffer);
+    TEST_MESSAGE(msg);
+  }
+
+  { // GPZ 编码
+    std::vector<GpxPointInternalV2> track = makeTrack(100000, 300);
+    std::vector<uint8_t> encoded(track.size() * GPZ_MAX_ENCODED_POINT_SIZE);
+    GpsDataEncoder encoder(64);
+    auto t0 = std::chrono::steady_clock::now();
+    size_t total = 0;
+    for (size_t i = 0; i < track.size(); i++) {
+      total += encoder.encodeTo(track[i], &encoded[total], encoded.size() - total);
+    }
+    double mpts = (double)track.size() / secondsSince(t0) / 1e6;
+    snprintf(msg, sizeof(msg), "GPZ encode: %.1f Mpts/s (%.2f B/pt)", mpts,
+             (double)total / track.size());
+    TEST_MESSAGE(msg);
+  }
+
+  { // 加速度分析器
+    AccelAnalyzer analyzer(256, 0.1f, 2.0f);
+    const int samples = 1000000;
+    uint32_t rng = 1;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; i++) {
+      rng = rng * 1664525u + 1013904223u;
+      analyzer.addSample(1.0f + ((int32_t)(rng % 21) - 10) * 0.01f);
+    }
+    double msps = (double)samples / secondsSince(t0) / 1e6;
+    snprintf(msg, sizeof(msg), "AccelAnalyzer: %.1f Msamples/s", msps);
+    TEST_MESSAGE(msg);
+  }
+}
+
+// --- MemArena ---
+
+static void test_arena_bump_and_reset() {
+  uint8_t buf[64];
+  MemArena arena(buf, sizeof(buf));
+
+  // 分配向上取整到 4 字节对齐
+  void *p1 = arena.alloc(5);
+  TEST_ASSERT_EQUAL_PTR(buf, p1);
+  TEST_ASSERT_EQUAL_UINT(8, arena.used());
+
+  char *s = arena.strdup("20260901.gpx");
+  TEST_ASSERT_NOT_NULL(s);
+  TEST_ASSERT_EQUAL_STRING("20260901.gpx", s);
+
+  // mark/release 临时作用域，highWater 记录峰值
+  size_t m = arena.mark();
+  TEST_ASSERT_NOT_NULL(arena.alloc(24));
+  arena.release(m);
+  TEST_ASSERT_EQUAL_UINT(m, arena.used());
+  TEST_ASSERT_EQUAL_UINT(m + 24, arena.highWater());
+
+  // 耗尽返回 nullptr，不越界
+  TEST_ASSERT_NULL(arena.alloc(100));
+
+  // 区域复位后整个容量可重新使用
+  arena.reset();
+  TEST_ASSERT_EQUAL_UINT(0, arena.used());
+  TEST_ASSERT_NOT_NULL(arena.alloc(64));
+  TEST_ASSERT_NULL(arena.alloc(4));
+}
+
+int main(int argc, char **argv) {
+  (void)argc;
+  (void)argv;
+  UNITY_BEGIN();
+  RUN_TEST(test_casic_parses_valid_frame);
+  RUN_TEST(test_casic_rejects_bad_checksum_and_recovers);
+  RUN_TEST(test_casic_resync_after_noise);
+  RUN_TEST(test_casic_process_buffer_matches_byte_path);
+  RUN_TEST(test_casic_nmea_passthrough);
+  RUN_TEST(test_gpz_roundtrip_walking);
+  RUN_TEST(test_gpz_roundtrip_stationary_exact);
+  RUN_TEST(test_gpz_full_block_cadence);
+  RUN_TEST(test_accel_still_then_jump);
+  RUN_TEST(test_accel_motion_not_still);
+  RUN_TEST(test_accel_window_slides_back_to_still);
+  RUN_TEST(test_arena_bump_and_reset);
+  RUN_TEST(test_throughput_report);
+  return UNITY_END();
+}
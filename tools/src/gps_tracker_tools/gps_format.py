@@ -227,7 +227,7 @@ class GpsFormatEncoder:
         zz_value = (value << 1) ^ (value >> 31)
         result = bytearray()
         while zz_value >= 0x80:
-            result.append(zz_value | 0x80)
+            result.append((zz_value & 0x7F) | 0x80)
             zz_value >>= 7
         result.append(zz_value)
         return result